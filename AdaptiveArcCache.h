@@ -0,0 +1,236 @@
+#pragma once
+
+#include <algorithm>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+#include "CacheOps.h"
+#include "CacheSer.h"
+#include "HashCaches.h"
+
+namespace MyCache
+{
+
+// 按原论文实现的 ARC：T1/T2 是只访问过一次/至少两次的驻留条目，B1/B2 是对应的幽灵 key，
+// 目标大小 p 在 B1 命中时按 |B2|/|B1| 增大、B2 命中时按 |B1|/|B2| 减小。
+// 与 ArcCache（LRU 部分 + LFU 部分）并存，便于对比命中率和吞吐。
+// 幽灵命中只在 put（即缺失后的回填）时触发自适应，get 缺失不改变状态。
+template<typename Key, typename Value>
+class AdaptiveArcCache : public CacheSer<Key, Value>, public CacheOps<AdaptiveArcCache<Key, Value>, Key, Value>
+{
+private:
+    enum class ListId { T1, T2, B1, B2 };
+
+    using KeyList = std::list<Key>;
+    using KeyIter = typename KeyList::iterator;
+
+    struct Entry
+    {
+        Value   value;
+        ListId  list;
+        KeyIter pos;
+    };
+
+public:
+    explicit AdaptiveArcCache(size_t capacity = 10)
+        : capacity_(capacity)
+        , p_(0)
+    {}
+
+    ~AdaptiveArcCache() override = default;
+
+    void put(Key key, Value value) override
+    {
+        if (capacity_ == 0)
+            return;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        putInternal(key, value);
+    }
+
+    bool get(Key key, Value& value) override
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(key);
+        if (it == entries_.end() || !isResident(it->second.list))
+            return false;
+
+        moveTo(it->second, ListId::T2);
+        value = it->second.value;
+        return true;
+    }
+
+    Value get(Key key) override
+    {
+        Value value{};
+        get(key, value);
+        return value;
+    }
+
+    void remove(Key key)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(key);
+        if (it != entries_.end())
+            removeInternal(it);
+    }
+
+    // 原子读改写的底层原语，见 CacheOps.h；幽灵 key 视为不存在
+    template<typename Fn>
+    void mutate(const Key& key, Fn fn)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(key);
+        bool resident = it != entries_.end() && isResident(it->second.list);
+        Mutation<Value> mutation = fn(resident ? &it->second.value : nullptr);
+        switch (mutation.kind)
+        {
+        case Mutation<Value>::Kind::Keep:
+            if (resident)
+                moveTo(it->second, ListId::T2);
+            break;
+        case Mutation<Value>::Kind::Set:
+            if (capacity_ > 0)
+                putInternal(key, mutation.value);
+            break;
+        case Mutation<Value>::Kind::Remove:
+            if (resident)
+                removeInternal(it);
+            break;
+        }
+    }
+
+    size_t targetT1Size()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return p_;
+    }
+
+private:
+    void putInternal(const Key& key, const Value& value)
+    {
+        auto it = entries_.find(key);
+        if (it == entries_.end())
+        {
+            admitNew(key, value);
+            return;
+        }
+
+        Entry& entry = it->second;
+        switch (entry.list)
+        {
+        case ListId::T1:
+        case ListId::T2:
+            entry.value = value;
+            moveTo(entry, ListId::T2);
+            break;
+        case ListId::B1:
+            p_ = std::min(capacity_, p_ + std::max<size_t>(b2_.size() / b1_.size(), 1));
+            replace(false);
+            entry.value = value;
+            moveTo(entry, ListId::T2);
+            break;
+        case ListId::B2:
+            p_ -= std::min(p_, std::max<size_t>(b1_.size() / b2_.size(), 1));
+            replace(true);
+            entry.value = value;
+            moveTo(entry, ListId::T2);
+            break;
+        }
+    }
+
+    void removeInternal(typename std::unordered_map<Key, Entry>::iterator it)
+    {
+        listOf(it->second.list).erase(it->second.pos);
+        entries_.erase(it);
+    }
+
+    static bool isResident(ListId list) { return list == ListId::T1 || list == ListId::T2; }
+
+    KeyList& listOf(ListId list)
+    {
+        switch (list)
+        {
+        case ListId::T1: return t1_;
+        case ListId::T2: return t2_;
+        case ListId::B1: return b1_;
+        default:         return b2_;
+        }
+    }
+
+    void moveTo(Entry& entry, ListId target)
+    {
+        KeyList& from = listOf(entry.list);
+        KeyList& to = listOf(target);
+        to.splice(to.begin(), from, entry.pos);
+        entry.list = target;
+    }
+
+    // 论文中的 Case IV：key 不在任何一个列表里
+    void admitNew(const Key& key, const Value& value)
+    {
+        size_t l1 = t1_.size() + b1_.size();
+        size_t total = l1 + t2_.size() + b2_.size();
+        if (l1 >= capacity_)
+        {
+            if (t1_.size() < capacity_)
+            {
+                dropLru(b1_);
+                replace(false);
+            }
+            else
+            {
+                dropLru(t1_);
+            }
+        }
+        else if (total >= capacity_)
+        {
+            if (total >= 2 * capacity_)
+                dropLru(b2_);
+            replace(false);
+        }
+
+        t1_.push_front(key);
+        entries_.emplace(key, Entry{value, ListId::T1, t1_.begin()});
+    }
+
+    // 驻留条目已满时，按 p 从 T1 或 T2 的 LRU 端淘汰一个到对应的幽灵列表
+    void replace(bool inB2)
+    {
+        if (t1_.size() + t2_.size() < capacity_)
+            return;
+
+        bool fromT1 = !t1_.empty() && (t1_.size() > p_ || (inB2 && t1_.size() == p_));
+        if (!fromT1 && t2_.empty())
+            fromT1 = true;
+
+        KeyList& source = fromT1 ? t1_ : t2_;
+        Entry& victim = entries_.find(source.back())->second;
+        victim.value = Value{};
+        moveTo(victim, fromT1 ? ListId::B1 : ListId::B2);
+    }
+
+    void dropLru(KeyList& list)
+    {
+        if (list.empty())
+            return;
+        entries_.erase(list.back());
+        list.pop_back();
+    }
+
+private:
+    size_t                          capacity_;
+    size_t                          p_;
+    std::mutex                      mutex_;
+    std::unordered_map<Key, Entry>  entries_;
+    KeyList                         t1_;
+    KeyList                         t2_;
+    KeyList                         b1_;
+    KeyList                         b2_;
+};
+
+template<typename Key, typename Value>
+using HashAdaptiveArcCaches = HashCaches<Key, Value, AdaptiveArcCache<Key, Value>>;
+
+}
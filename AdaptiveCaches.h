@@ -0,0 +1,458 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "ArcCache.h"
+#include "CacheSer.h"
+#include "LfuBase.h"
+#include "LruBase.h"
+#include "kLruCache.h"
+
+namespace MyCache
+{
+
+enum class PolicyKind { Lru, Lfu, Arc, KLru };
+
+// param 的含义随策略不同：LFU 为 maxAverageNum，ARC 为 transformThreshold，K-LRU 为 k，LRU 不使用
+struct PolicyConfig
+{
+    PolicyKind kind;
+    int        param;
+
+    bool operator==(const PolicyConfig& other) const { return kind == other.kind && param == other.param; }
+    bool operator!=(const PolicyConfig& other) const { return !(*this == other); }
+};
+
+inline const char* policyName(PolicyKind kind)
+{
+    switch (kind)
+    {
+    case PolicyKind::Lru:  return "LRU";
+    case PolicyKind::Lfu:  return "LFU";
+    case PolicyKind::Arc:  return "ARC";
+    case PolicyKind::KLru: return "K-LRU";
+    }
+    return "?";
+}
+
+struct ShadowEstimate
+{
+    PolicyConfig config;
+    double       hitRatio;
+};
+
+// 某个分片最近一个周期的选择结果
+struct ShardDecision
+{
+    PolicyConfig                active;
+    double                      activeHitRatio = 0;
+    uint64_t                    epochs = 0;
+    uint64_t                    switches = 0;
+    uint64_t                    gets = 0;
+    uint64_t                    sampledGets = 0;
+    std::vector<ShadowEstimate> estimates;
+};
+
+// 每个分片自行选择策略与参数的分片缓存。按 key 哈希抽样约 shadowSize 个 key 的读访问，
+// 同时喂给每类策略的两个影子缓存（只存 key）：当前参数一份、试探参数一份。每 epochLength 次抽样访问结算一次：
+// 试探参数命中率更高则参数移过去并继续同方向试探，否则反向；本类策略的参数移动直接在分片上就地生效。
+// 另一类策略连续 kSwitchEpochs 个周期估计命中率高出 kSwitchMargin 才切换：新建空的分片缓存，旧缓存转为只读的
+// 迁移源，读未命中时从中取出并转入新缓存，写入与删除同时作用于旧缓存；新缓存累计转入 sliceSize 个条目后
+// 丢弃旧缓存（在分片锁外释放），迁移期间不再切换。新建的试探影子先预热一个周期再参与比较。
+template<typename Key, typename Value>
+class HashAdaptiveCaches
+{
+public:
+    HashAdaptiveCaches(size_t capacity, int sliceNum, PolicyConfig initial = PolicyConfig{PolicyKind::Lru, 0},
+                       size_t shadowSize = 256, uint64_t epochLength = 2048)
+        : sliceNum_(sliceNum > 0 ? sliceNum : std::max(1u, std::thread::hardware_concurrency()))
+        , sliceSize_(std::ceil(capacity / static_cast<double>(sliceNum_)))
+        , sampleRate_(std::max<size_t>(kMinSampleRate, sliceSize_ / std::max<size_t>(shadowSize, 1)))
+        , shadowSize_(std::max<size_t>(1, sliceSize_ / sampleRate_))
+        , epochLength_(std::max<uint64_t>(epochLength, 1))
+    {
+        for (int i = 0; i < sliceNum_; ++i)
+        {
+            auto shard = std::make_unique<Shard>();
+            shard->active = clampConfig(initial);
+            shard->cache = makeCache<Value>(shard->active, sliceSize_);
+            for (PolicyKind kind : {PolicyKind::Lru, PolicyKind::Lfu, PolicyKind::Arc, PolicyKind::KLru})
+            {
+                int param = kind == initial.kind ? shard->active.param : defaultParam(kind);
+                Family family;
+                family.current = makeShadow(PolicyConfig{kind, param});
+                family.current.warmedUp = true;
+                if (tunable(kind))
+                    family.probe = makeShadow(PolicyConfig{kind, stepParam(kind, param, family.direction)});
+                shard->families.push_back(std::move(family));
+            }
+            shards_.push_back(std::move(shard));
+        }
+    }
+
+    void put(Key key, Value value)
+    {
+        size_t hash = std::hash<Key>()(key);
+        Shard& shard = *shards_[hash % sliceNum_];
+        std::unique_ptr<CacheSer<Key, Value>> retired;
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.cache->put(key, value);
+        if (shard.source)
+        {
+            removeEntry(shard.sourceConfig, *shard.source, key);
+            retired = advanceMigration(shard);
+        }
+    }
+
+    bool get(Key key, Value& value)
+    {
+        size_t hash = std::hash<Key>()(key);
+        Shard& shard = *shards_[hash % sliceNum_];
+        // 声明在锁之前，迁移结束时换下的旧缓存在释放分片锁之后才析构
+        std::unique_ptr<CacheSer<Key, Value>> retired;
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        bool hit = shard.cache->get(key, value);
+        if (!hit && shard.source && shard.source->get(key, value))
+        {
+            removeEntry(shard.sourceConfig, *shard.source, key);
+            admit(shard.active, *shard.cache, key, value);
+            retired = advanceMigration(shard);
+            hit = true;
+        }
+        ++shard.gets;
+        ++shard.totalGets;
+        shard.hits += hit;
+        if (!sampled(hash))
+            return hit;
+
+        for (Family& family : shard.families)
+        {
+            family.current.access(key);
+            if (family.probe.cache)
+                family.probe.access(key);
+        }
+        if (++shard.sampledGets % epochLength_ == 0)
+            endEpoch(shard);
+        return hit;
+    }
+
+    Value get(Key key)
+    {
+        Value value{};
+        get(key, value);
+        return value;
+    }
+
+    void remove(Key key)
+    {
+        size_t hash = std::hash<Key>()(key);
+        Shard& shard = *shards_[hash % sliceNum_];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        removeEntry(shard.active, *shard.cache, key);
+        if (shard.source)
+            removeEntry(shard.sourceConfig, *shard.source, key);
+        if (!sampled(hash))
+            return;
+        for (Family& family : shard.families)
+        {
+            removeEntry(family.current.config, *family.current.cache, key);
+            if (family.probe.cache)
+                removeEntry(family.probe.config, *family.probe.cache, key);
+        }
+    }
+
+    // 每个分片当前的策略、最近一个周期的实际命中率与各影子缓存的估计命中率
+    std::vector<ShardDecision> decisions()
+    {
+        std::vector<ShardDecision> result;
+        for (auto& shard : shards_)
+        {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            ShardDecision decision;
+            decision.active = shard->active;
+            decision.activeHitRatio = shard->lastHitRatio;
+            decision.epochs = shard->epochs;
+            decision.switches = shard->switches;
+            decision.gets = shard->totalGets;
+            decision.sampledGets = shard->sampledGets;
+            decision.estimates = shard->lastEstimates;
+            result.push_back(std::move(decision));
+        }
+        return result;
+    }
+
+    int sliceNum() const { return sliceNum_; }
+
+private:
+    static constexpr double kSwitchMargin = 0.01;
+    static constexpr int    kSwitchEpochs = 2;
+    // 影子缓存最多为分片容量的 1/kMinSampleRate：分片较小时也只抽样部分 key，七个影子的开销不超过分片本身
+    static constexpr size_t kMinSampleRate = 4;
+
+    struct Shadow
+    {
+        PolicyConfig                         config{PolicyKind::Lru, 0};
+        std::unique_ptr<CacheSer<Key, char>> cache;
+        uint64_t                             gets = 0;
+        uint64_t                             hits = 0;
+        bool                                 warmedUp = false;
+
+        // 影子缓存模拟"读未命中即回填"，实际缓存的 put 不再转发给影子，免得回填被计为第二次访问
+        void access(const Key& key)
+        {
+            char unused;
+            ++gets;
+            if (cache->get(key, unused))
+                ++hits;
+            else
+                cache->put(key, 0);
+        }
+
+        double hitRatio() const { return gets ? static_cast<double>(hits) / gets : 0; }
+    };
+
+    // 同一类策略的当前参数影子与试探参数影子；LRU 没有参数，不设试探
+    struct Family
+    {
+        Shadow current;
+        Shadow probe;
+        int    direction = 1;
+    };
+
+    struct Shard
+    {
+        std::mutex                            mutex;
+        PolicyConfig                          active{PolicyKind::Lru, 0};
+        std::unique_ptr<CacheSer<Key, Value>> cache;
+        std::vector<Family>                   families;
+        uint64_t                              gets = 0;
+        uint64_t                              hits = 0;
+        uint64_t                              totalGets = 0;
+        uint64_t                              sampledGets = 0;
+        uint64_t                              epochs = 0;
+        uint64_t                              switches = 0;
+        double                                lastHitRatio = 0;
+        std::vector<ShadowEstimate>           lastEstimates;
+        // 切换策略后的迁移源，为空表示没有进行中的迁移
+        std::unique_ptr<CacheSer<Key, Value>> source;
+        PolicyConfig                          sourceConfig{PolicyKind::Lru, 0};
+        size_t                                migrated = 0;
+        // 连续领先的另一类策略及其领先的周期数
+        PolicyKind                            challenger = PolicyKind::Lru;
+        int                                   challengerEpochs = 0;
+    };
+
+    static bool tunable(PolicyKind kind) { return kind != PolicyKind::Lru; }
+
+    static int defaultParam(PolicyKind kind)
+    {
+        switch (kind)
+        {
+        case PolicyKind::Lfu:  return 10;
+        case PolicyKind::Arc:  return 2;
+        case PolicyKind::KLru: return 2;
+        default:               return 0;
+        }
+    }
+
+    static int minParam(PolicyKind kind) { return kind == PolicyKind::Arc ? 1 : 2; }
+    static int maxParam(PolicyKind kind)
+    {
+        switch (kind)
+        {
+        case PolicyKind::Lfu:  return 1024;
+        case PolicyKind::Arc:  return 64;
+        case PolicyKind::KLru: return 8;
+        default:               return 0;
+        }
+    }
+
+    static PolicyConfig clampConfig(PolicyConfig config)
+    {
+        if (!tunable(config.kind))
+            return PolicyConfig{config.kind, 0};
+        return PolicyConfig{config.kind, std::clamp(config.param, minParam(config.kind), maxParam(config.kind))};
+    }
+
+    // LFU 与 ARC 的参数按倍数调整，K-LRU 的 k 逐一调整；碰到边界时改向另一侧
+    static int stepParam(PolicyKind kind, int param, int& direction)
+    {
+        for (int attempt = 0; attempt < 2; ++attempt)
+        {
+            int next = kind == PolicyKind::KLru ? param + direction
+                     : direction > 0             ? param * 2
+                                                 : param / 2;
+            next = std::clamp(next, minParam(kind), maxParam(kind));
+            if (next != param)
+                return next;
+            direction = -direction;
+        }
+        return param;
+    }
+
+    template<typename V>
+    static std::unique_ptr<CacheSer<Key, V>> makeCache(const PolicyConfig& config, size_t capacity)
+    {
+        int size = static_cast<int>(capacity);
+        switch (config.kind)
+        {
+        case PolicyKind::Lfu:  return std::make_unique<LfuBase<Key, V>>(size, config.param);
+        case PolicyKind::Arc:  return std::make_unique<ArcCache<Key, V>>(capacity, config.param);
+        case PolicyKind::KLru: return std::make_unique<KLruCache<Key, V>>(size, size, config.param);
+        default:               return std::make_unique<LruBase<Key, V>>(size);
+        }
+    }
+
+    template<typename V>
+    static void removeEntry(const PolicyConfig& config, CacheSer<Key, V>& cache, const Key& key)
+    {
+        switch (config.kind)
+        {
+        case PolicyKind::Lfu:  static_cast<LfuBase<Key, V>&>(cache).remove(key); break;
+        case PolicyKind::Arc:  static_cast<ArcCache<Key, V>&>(cache).remove(key); break;
+        default:               static_cast<LruBase<Key, V>&>(cache).remove(key); break;
+        }
+    }
+
+    // 从迁移源转入的条目直接进入缓存，K-LRU 不再重新累计访问次数
+    template<typename V>
+    static void admit(const PolicyConfig& config, CacheSer<Key, V>& cache, const Key& key, const V& value)
+    {
+        if (config.kind == PolicyKind::KLru)
+            static_cast<LruBase<Key, V>&>(cache).LruBase<Key, V>::put(key, value);
+        else
+            cache.put(key, value);
+    }
+
+    Shadow makeShadow(const PolicyConfig& config) const
+    {
+        Shadow shadow;
+        shadow.config = config;
+        shadow.cache = makeCache<char>(config, shadowSize_);
+        return shadow;
+    }
+
+    // 抽样用乘法散列的高位，与选分片用的低位取模互不相关
+    bool sampled(size_t hash) const
+    {
+        return ((hash * 0x9E3779B97F4A7C15ULL) >> 40) % sampleRate_ == 0;
+    }
+
+    // 需持有分片锁
+    void endEpoch(Shard& shard)
+    {
+        ++shard.epochs;
+        shard.lastHitRatio = shard.gets ? static_cast<double>(shard.hits) / shard.gets : 0;
+        shard.gets = 0;
+        shard.hits = 0;
+        shard.lastEstimates.clear();
+
+        Family* best = nullptr;
+        Family* activeFamily = nullptr;
+        for (Family& family : shard.families)
+        {
+            shard.lastEstimates.push_back(ShadowEstimate{family.current.config, family.current.hitRatio()});
+            if (family.probe.cache && family.probe.warmedUp)
+                shard.lastEstimates.push_back(ShadowEstimate{family.probe.config, family.probe.hitRatio()});
+            climb(family);
+            if (!best || family.current.hitRatio() > best->current.hitRatio())
+                best = &family;
+            if (family.current.config.kind == shard.active.kind)
+                activeFamily = &family;
+        }
+
+        if (activeFamily->current.config.param != shard.active.param)
+            applyParam(shard, activeFamily->current.config.param);
+
+        // 影子只按抽样估计，分片实际命中率更低时以实际值为准，避免实际表现差的策略一直占着分片
+        double activeRatio = std::min(activeFamily->current.hitRatio(), shard.lastHitRatio);
+        if (best != activeFamily && best->current.hitRatio() > activeRatio + kSwitchMargin)
+        {
+            PolicyKind kind = best->current.config.kind;
+            shard.challengerEpochs = shard.challenger == kind ? shard.challengerEpochs + 1 : 1;
+            shard.challenger = kind;
+            if (shard.challengerEpochs >= kSwitchEpochs && !shard.source)
+                switchPolicy(shard, best->current.config);
+        }
+        else
+        {
+            shard.challengerEpochs = 0;
+        }
+
+        for (Family& family : shard.families)
+        {
+            family.current.gets = family.current.hits = 0;
+            family.probe.gets = family.probe.hits = 0;
+        }
+    }
+
+    // 试探参数胜出时连同影子一起接管，保留其已有的状态；之后在新参数的同方向上建立新的试探影子
+    void climb(Family& family)
+    {
+        if (!family.probe.cache)
+            return;
+        if (!family.probe.warmedUp)
+        {
+            family.probe.warmedUp = true;
+            return;
+        }
+        if (family.probe.hitRatio() > family.current.hitRatio() + kSwitchMargin)
+            std::swap(family.current, family.probe);
+        else
+            family.direction = -family.direction;
+
+        PolicyKind kind = family.current.config.kind;
+        int param = stepParam(kind, family.current.config.param, family.direction);
+        family.probe = makeShadow(PolicyConfig{kind, param});
+    }
+
+    // 同类策略的参数移动就地生效，不重建分片，已有条目的频率等状态保留
+    static void applyParam(Shard& shard, int param)
+    {
+        switch (shard.active.kind)
+        {
+        case PolicyKind::Lfu:  static_cast<LfuBase<Key, Value>&>(*shard.cache).setMaxAverageNum(param); break;
+        case PolicyKind::Arc:  static_cast<ArcCache<Key, Value>&>(*shard.cache).setTransformThreshold(param); break;
+        case PolicyKind::KLru: static_cast<KLruCache<Key, Value>&>(*shard.cache).setK(param); break;
+        default:               break;
+        }
+        shard.active.param = param;
+    }
+
+    // 只换上空的新缓存，旧缓存留作迁移源，由之后的读写逐步转入，结算周期的这次读取不做迁移
+    void switchPolicy(Shard& shard, const PolicyConfig& target)
+    {
+        shard.source = std::move(shard.cache);
+        shard.sourceConfig = shard.active;
+        shard.migrated = 0;
+        shard.cache = makeCache<Value>(target, sliceSize_);
+        shard.active = target;
+        shard.challengerEpochs = 0;
+        ++shard.switches;
+    }
+
+    // 需持有分片锁；新缓存已转入或写入 sliceSize 个条目后结束迁移，返回换下的旧缓存由调用方在锁外释放
+    std::unique_ptr<CacheSer<Key, Value>> advanceMigration(Shard& shard)
+    {
+        if (++shard.migrated < sliceSize_)
+            return nullptr;
+        return std::move(shard.source);
+    }
+
+private:
+    int                                 sliceNum_;
+    size_t                              sliceSize_;
+    size_t                              sampleRate_;
+    size_t                              shadowSize_;
+    uint64_t                            epochLength_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+}
@@ -1,52 +1,149 @@
 #pragma once
 
+#include "CacheOps.h"
 #include "CacheSer.h"
 #include "ArcLruPart.h"
 #include "ArcLfuPart.h"
 #include <memory>
+#include <mutex>
+#include <shared_mutex>
 
 namespace MyCache 
 {
 
 template<typename Key, typename Value>
-class ArcCache : public CacheSer<Key, Value> 
+class ArcCache : public CacheSer<Key, Value>, public CacheOps<ArcCache<Key, Value>, Key, Value>
 {
 public:
-    explicit ArcCache(size_t capacWity = 10, size_t transformThreshold = 2)
+    explicit ArcCache(size_t capacity = 10, size_t transformThreshold = 2)
+        : ArcCache(capacity, transformThreshold, capacity)
+    {}
+
+    ArcCache(size_t capacity, size_t transformThreshold, size_t ghostCapacity)
         : capacity_(capacity)
         , transformThreshold_(transformThreshold)
-        , lruPart_(std::make_unique<ArcLruPart<Key, Value>>(capacity, transformThreshold))
-        , lfuPart_(std::make_unique<ArcLfuPart<Key, Value>>(capacity, transformThreshold))
+        , lruPart_(std::make_unique<ArcLruPart<Key, Value>>(capacity, transformThreshold, ghostCapacity))
+        , lfuPart_(std::make_unique<ArcLfuPart<Key, Value>>(capacity, transformThreshold, ghostCapacity))
     {}
 
-    ~KArcCache() override = default;
+    ~ArcCache() override = default;
 
+    // 两个部分各自加锁。get/put 只持有 mutex_ 的共享锁，彼此之间并发，不比引入 mutate 之前多串行化；
+    // 读改写与 remove 持有独占锁，执行期间没有其他跨部分操作，整体原子
     void put(Key key, const Value value) override
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        putInternal(key, value);
+    }
+
+    bool get(Key key, Value& value) override 
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        return getInternal(key, value);
+    }
+
+    Value get(Key key) override 
+    {
+        Value value{};
+        get(key, value);
+        return value;
+    }
+
+    void remove(Key key)
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        lruPart_->remove(key);
+        lfuPart_->remove(key);
+    }
+
+    // 原子读改写的底层原语，见 CacheOps.h
+    template<typename Fn>
+    void mutate(const Key& key, Fn fn)
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        Value current{};
+        bool present = lruPart_->peek(key, current) || lfuPart_->peek(key, current);
+        Mutation<Value> mutation = fn(present ? &current : nullptr);
+        switch (mutation.kind)
+        {
+        case Mutation<Value>::Kind::Keep:
+            if (present)
+                getInternal(key, current);
+            break;
+        case Mutation<Value>::Kind::Set:
+            putInternal(key, mutation.value);
+            break;
+        case Mutation<Value>::Kind::Remove:
+            lruPart_->remove(key);
+            lfuPart_->remove(key);
+            break;
+        }
+    }
+
+    // LRU、LFU 两部分（含各自的幽灵表）的内存占用之和，见 MemoryUsage.h
+    MemoryUsage memoryUsage()
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        MemoryUsage usage = lruPart_->memoryUsage();
+        usage += lfuPart_->memoryUsage();
+        return usage;
+    }
+
+    // 就地调整晋升到 LFU 部分所需的访问次数，已缓存的条目保持原位
+    void setTransformThreshold(size_t transformThreshold)
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        transformThreshold_ = transformThreshold;
+        lruPart_->setTransformThreshold(transformThreshold);
+    }
+
+    // 先遍历 LFU 部分再遍历 LRU 部分，两部分都有的 key 会出现两次，后一次是较新的值
+    template<typename Fn>
+    void forEach(Fn fn)
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        lfuPart_->forEach(fn);
+        lruPart_->forEach(fn);
+    }
+
+private:
+    void putInternal(const Key& key, const Value& value)
     {
         bool inGhost = checkGhostCaches(key);
+        bool toLru = false;
+        bool toLfu = false;
         if (!inGhost)  
         {
             Value value_t;
             bool shouldTransform = false;
             if (lruPart_->get(key, value_t, shouldTransform)) 
             { 
-                lruPart_->put(key, value); 
-                if (shouldTransform)
-                    lfuPart_->put(key, value);
+                toLru = true;
+                toLfu = shouldTransform;
             }
             else if(lfuPart_->get(key, value_t)) 
-                lfuPart_->put(key, value);
+                toLfu = true;
             else  
-                lruPart_->put(key, value);
+                toLru = true;
 
         }
         else if (lruPart_->checkGhost(key)) 
-            lruPart_->put(key, value);
+            toLru = true;
         else
+            toLfu = true;
+
+        if (toLru)
+            lruPart_->put(key, value);
+        if (toLfu)
             lfuPart_->put(key, value);
+        // 晋升过的 key 在两部分各有一份，只写了其中一部分时把另一份同步为新值，避免之后读到旧值
+        if (!toLru)
+            lruPart_->assign(key, value);
+        if (!toLfu)
+            lfuPart_->assign(key, value);
     }
 
-    bool get(Key key, Value& value) override 
+    bool getInternal(const Key& key, Value& value)
     {
         checkGhostCaches(key);
 
@@ -62,14 +159,6 @@ public:
         return lfuPart_->get(key, value);
     }
 
-    Value get(Key key) override 
-    {
-        Value value{};
-        get(key, value);
-        return value;
-    }
-
-private:
     bool checkGhostCaches(Key key) 
     {
         bool inGhost = false;
@@ -95,6 +184,7 @@ private:
 private:
     size_t capacity_;
     size_t transformThreshold_;
+    std::shared_mutex mutex_;
     std::unique_ptr<ArcLruPart<Key, Value>> lruPart_;
     std::unique_ptr<ArcLfuPart<Key, Value>> lfuPart_;
 };
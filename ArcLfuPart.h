@@ -2,9 +2,12 @@
 
 #include <unordered_map>
 #include <map>
+#include <list>
 #include <mutex>
 
 #include "ArcCacheNode.h"
+#include "GhostFifo.h"
+#include "MemoryUsage.h"
 
 namespace MyCache 
 {
@@ -15,24 +18,30 @@ class ArcLfuPart
 public:
     using NodeType = ArcNode<Key, Value>;
     using NodePtr = std::shared_ptr<NodeType>;
-    using NodeMap = std::unordered_map<Key, NodePtr>;
-    using FreqMap = std::map<size_t, std::list<NodePtr>>;
+    using NodeMap = std::unordered_map<Key, NodePtr, std::hash<Key>, std::equal_to<Key>,
+                                       CountingAllocator<std::pair<const Key, NodePtr>>>;
+    using NodeList = std::list<NodePtr, CountingAllocator<NodePtr>>;
+    using FreqMap = std::map<size_t, NodeList, std::less<size_t>, CountingAllocator<std::pair<const size_t, NodeList>>>;
 
     explicit ArcLfuPart(size_t capacity, size_t transformThreshold)
+        : ArcLfuPart(capacity, transformThreshold, capacity)
+    {}
+
+    ArcLfuPart(size_t capacity, size_t transformThreshold, size_t ghostCapacity)
         : capacity_(capacity)
-        , ghostCapacity_(capacity)
         , transformThreshold_(transformThreshold)
         , minFreq_(0)
-    {
-        initializeLists();
-    }
+        , mainCache_(CountingAllocator<std::pair<const Key, NodePtr>>(&indexBytes_))
+        , ghost_(ghostCapacity)
+        , freqMap_(CountingAllocator<std::pair<const size_t, NodeList>>(&listBytes_))
+    {}
 
     bool put(Key key, Value value) 
     {
+        std::lock_guard<std::mutex> lock(mutex_);
         if (capacity_ == 0) 
             return false;
 
-        std::lock_guard<std::mutex> lock(mutex_);
         auto it = mainCache_.find(key);
         if (it != mainCache_.end()) 
         {
@@ -54,22 +63,101 @@ public:
         return false;
     }
 
+    // 只读取值，不更新访问信息
+    bool peek(const Key& key, Value& value)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = mainCache_.find(key);
+        if (it == mainCache_.end())
+            return false;
+        value = it->second->getValue();
+        return true;
+    }
+
+    // key 存在时只替换值，不更新访问信息
+    bool assign(const Key& key, const Value& value)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = mainCache_.find(key);
+        if (it == mainCache_.end())
+            return false;
+        it->second->setValue(value);
+        return true;
+    }
+
+    // 显式删除，不进入幽灵列表
+    void remove(const Key& key)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = mainCache_.find(key);
+        if (it == mainCache_.end())
+            return;
+
+        NodePtr node = it->second;
+        size_t freq = node->getAccessCount();
+        auto& list = freqMap_[freq];
+        list.remove(node);
+        if (list.empty())
+        {
+            freqMap_.erase(freq);
+            if (freq == minFreq_ && !freqMap_.empty())
+                minFreq_ = freqMap_.begin()->first;
+        }
+        mainCache_.erase(it);
+    }
+
+    // 按淘汰顺序（频率从低到高，同频率先进先出）遍历 fn(key, value)
+    template<typename Fn>
+    void forEach(Fn fn)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& entry : freqMap_)
+        {
+            for (const NodePtr& node : entry.second)
+            {
+                fn(node->getKey(), node->getValue());
+            }
+        }
+    }
+
     bool checkGhost(Key key) 
     {
-        auto it = ghostCache_.find(key);
-        if (it != ghostCache_.end()) 
+        std::lock_guard<std::mutex> lock(mutex_);
+        return ghost_.erase(GhostFifo::fingerprint(key));
+    }
+
+    // 按分配计数统计内存占用，幽灵表计入元数据
+    MemoryUsage memoryUsage()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        MemoryUsage usage;
+        usage.entries = mainCache_.size();
+        usage.indexBytes = indexBytes_.load(std::memory_order_relaxed);
+        usage.payloadBytes = usage.entries * (sizeof(Key) + sizeof(Value));
+        usage.metadataBytes = nodeBytes_.load(std::memory_order_relaxed) - usage.payloadBytes
+                            + listBytes_.load(std::memory_order_relaxed)
+                            + ghost_.memoryBytes();
+        if constexpr (kMayOwnHeap<Key> || kMayOwnHeap<Value>)
         {
-            removeFromGhost(it->second);
-            ghostCache_.erase(it);
-            return true;
+            for (const auto& entry : mainCache_)
+            {
+                usage.indexBytes += heapBytes(entry.first);
+                usage.payloadBytes += heapBytes(entry.second->key_) + heapBytes(entry.second->value_);
+            }
         }
-        return false;
+        return usage;
     }
 
-    void increaseCapacity() { ++capacity_; }
+    // 容量调整与 get/put 可能在不同线程并发，同样持有本部分的锁
+    void increaseCapacity()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++capacity_;
+    }
     
     bool decreaseCapacity() 
     {
+        std::lock_guard<std::mutex> lock(mutex_);
         if (capacity_ <= 0) return false;
         if (mainCache_.size() == capacity_) 
         {
@@ -80,14 +168,6 @@ public:
     }
 
 private:
-    void initializeLists() 
-    {
-        ghostHead_ = std::make_shared<NodeType>();
-        ghostTail_ = std::make_shared<NodeType>();
-        ghostHead_->next_ = ghostTail_;
-        ghostTail_->prev_ = ghostHead_;
-    }
-
     bool updateExistingNode(NodePtr node, const Value& value) 
     {
         node->setValue(value);
@@ -102,19 +182,23 @@ private:
             evictLeastFrequent();
         }
 
-        NodePtr newNode = std::make_shared<NodeType>(key, value);
+        NodePtr newNode = std::allocate_shared<NodeType>(CountingAllocator<NodeType>(&nodeBytes_), key, value);
         mainCache_[key] = newNode;
-
-        if (freqMap_.find(1) == freqMap_.end()) 
-        {
-            freqMap_[1] = std::list<NodePtr>();
-        }
-        freqMap_[1].push_back(newNode);
+        listOf(1).push_back(newNode);
         minFreq_ = 1;
         
         return true;
     }
 
+    // 取频率对应的链表，不存在时用本分片的计数分配器新建
+    NodeList& listOf(size_t freq)
+    {
+        auto it = freqMap_.find(freq);
+        if (it == freqMap_.end())
+            it = freqMap_.emplace(freq, NodeList(CountingAllocator<NodePtr>(&listBytes_))).first;
+        return it->second;
+    }
+
     void updateNodeFrequency(NodePtr node) 
     {
         size_t oldFreq = node->getAccessCount();
@@ -132,11 +216,7 @@ private:
             }
         }
 
-        if (freqMap_.find(newFreq) == freqMap_.end()) 
-        {
-            freqMap_[newFreq] = std::list<NodePtr>();
-        }
-        freqMap_[newFreq].push_back(node);
+        listOf(newFreq).push_back(node);
     }
 
     void evictLeastFrequent() 
@@ -160,53 +240,23 @@ private:
             }
         }
 
-        if (ghostCache_.size() >= ghostCapacity_) 
-        {
-            removeOldestGhost();
-        }
-        addToGhost(leastNode);
-        
+        ghost_.insert(GhostFifo::fingerprint(leastNode->getKey()));
         mainCache_.erase(leastNode->getKey());
     }
 
-    void removeFromGhost(NodePtr node) 
-    {
-        node->prev_->next_ = node->next_;
-        node->next_->prev_ = node->prev_;
-    }
-
-    void addToGhost(NodePtr node) 
-    {
-        node->next_ = ghostTail_;
-        node->prev_ = ghostTail_->prev_;
-        ghostTail_->prev_->next_ = node;
-        ghostTail_->prev_ = node;
-        ghostCache_[node->getKey()] = node;
-    }
-
-    void removeOldestGhost() 
-    {
-        NodePtr oldestGhost = ghostHead_->next_;
-        if (oldestGhost != ghostTail_) 
-        {
-            removeFromGhost(oldestGhost);
-            ghostCache_.erase(oldestGhost->getKey());
-        }
-    }
-
 private:
     size_t capacity_;
-    size_t ghostCapacity_;
     size_t transformThreshold_;
     size_t minFreq_;
     std::mutex mutex_;
 
+    // 计数器须先于使用它们的容器构造、晚于其析构
+    AllocationCounter indexBytes_{0};
+    AllocationCounter nodeBytes_{0};
+    AllocationCounter listBytes_{0};
     NodeMap mainCache_;
-    NodeMap ghostCache_;
+    GhostFifo ghost_;
     FreqMap freqMap_;
-    
-    NodePtr ghostHead_;
-    NodePtr ghostTail_;
 };
 
 }
\ No newline at end of file
@@ -4,6 +4,8 @@
 #include <mutex>
 
 #include "ArcCacheNode.h"
+#include "GhostFifo.h"
+#include "MemoryUsage.h"
 
 namespace MyCache 
 {
@@ -14,21 +16,39 @@ class ArcLruPart
 public:
     using NodeType = ArcNode<Key, Value>;
     using NodePtr = std::shared_ptr<NodeType>;
-    using NodeMap = std::unordered_map<Key, NodePtr>;
+    using NodeMap = std::unordered_map<Key, NodePtr, std::hash<Key>, std::equal_to<Key>,
+                                       CountingAllocator<std::pair<const Key, NodePtr>>>;
 
     explicit ArcLruPart(size_t capacity, size_t transformThreshold)
+        : ArcLruPart(capacity, transformThreshold, capacity)
+    {}
+
+    ArcLruPart(size_t capacity, size_t transformThreshold, size_t ghostCapacity)
         : capacity_(capacity)
-        , ghostCapacity_(capacity)
         , transformThreshold_(transformThreshold)
+        , mainCache_(CountingAllocator<std::pair<const Key, NodePtr>>(&indexBytes_))
+        , ghost_(ghostCapacity)
     {
         initializeLists();
     }
 
+    // 相邻节点互相持有，逐个断开链接，避免引用环泄漏
+    ~ArcLruPart()
+    {
+        NodePtr node = std::move(mainHead_);
+        while (node)
+        {
+            NodePtr next = std::move(node->next_);
+            node->prev_.reset();
+            node = std::move(next);
+        }
+    }
+
     bool put(Key key, Value value) 
     {
+        std::lock_guard<std::mutex> lock(mutex_);
         if (capacity_ == 0) return false;
         
-        std::lock_guard<std::mutex> lock(mutex_);
         auto it = mainCache_.find(key);
         if (it != mainCache_.end()) 
         {
@@ -50,21 +70,94 @@ public:
         return false;
     }
 
+    // 只读取值，不更新访问信息
+    bool peek(const Key& key, Value& value)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = mainCache_.find(key);
+        if (it == mainCache_.end())
+            return false;
+        value = it->second->getValue();
+        return true;
+    }
+
+    // key 存在时只替换值，不更新访问信息
+    bool assign(const Key& key, const Value& value)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = mainCache_.find(key);
+        if (it == mainCache_.end())
+            return false;
+        it->second->setValue(value);
+        return true;
+    }
+
+    // 显式删除，不进入幽灵列表
+    void remove(const Key& key)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = mainCache_.find(key);
+        if (it == mainCache_.end())
+            return;
+        removeFromMain(it->second);
+        mainCache_.erase(it);
+    }
+
+    // 从最久未使用到最近使用遍历 fn(key, value)
+    // 只影响之后的访问，已有节点的访问计数保留
+    void setTransformThreshold(size_t transformThreshold)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        transformThreshold_ = transformThreshold;
+    }
+
+    template<typename Fn>
+    void forEach(Fn fn)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (NodePtr node = mainTail_->prev_; node != mainHead_; node = node->prev_)
+        {
+            fn(node->getKey(), node->getValue());
+        }
+    }
+
     bool checkGhost(Key key) 
     {
-        auto it = ghostCache_.find(key);
-        if (it != ghostCache_.end()) {
-            removeFromGhost(it->second);
-            ghostCache_.erase(it);
-            return true;
+        std::lock_guard<std::mutex> lock(mutex_);
+        return ghost_.erase(GhostFifo::fingerprint(key));
+    }
+
+    // 按分配计数统计内存占用，幽灵表计入元数据
+    MemoryUsage memoryUsage()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        MemoryUsage usage;
+        usage.entries = mainCache_.size();
+        usage.indexBytes = indexBytes_.load(std::memory_order_relaxed);
+        usage.payloadBytes = usage.entries * (sizeof(Key) + sizeof(Value));
+        usage.metadataBytes = nodeBytes_.load(std::memory_order_relaxed) - usage.payloadBytes
+                            + ghost_.memoryBytes();
+        if constexpr (kMayOwnHeap<Key> || kMayOwnHeap<Value>)
+        {
+            for (const auto& entry : mainCache_)
+            {
+                usage.indexBytes += heapBytes(entry.first);
+                usage.payloadBytes += heapBytes(entry.second->key_) + heapBytes(entry.second->value_);
+            }
         }
-        return false;
+        return usage;
     }
 
-    void increaseCapacity() { ++capacity_; }
+    // 容量调整与 get/put 可能在不同线程并发，同样持有本部分的锁
+    void increaseCapacity()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++capacity_;
+    }
     
     bool decreaseCapacity() 
     {
+        std::lock_guard<std::mutex> lock(mutex_);
         if (capacity_ <= 0) return false;
         if (mainCache_.size() == capacity_) {
             evictLeastRecent();
@@ -76,15 +169,17 @@ public:
 private:
     void initializeLists() 
     {
-        mainHead_ = std::make_shared<NodeType>();
-        mainTail_ = std::make_shared<NodeType>();
+        mainHead_ = makeNode();
+        mainTail_ = makeNode();
         mainHead_->next_ = mainTail_;
         mainTail_->prev_ = mainHead_;
+    }
 
-        ghostHead_ = std::make_shared<NodeType>();
-        ghostTail_ = std::make_shared<NodeType>();
-        ghostHead_->next_ = ghostTail_;
-        ghostTail_->prev_ = ghostHead_;
+    // 节点与 shared_ptr 控制块一次分配，记入节点计数
+    template<typename... Args>
+    NodePtr makeNode(Args&&... args)
+    {
+        return std::allocate_shared<NodeType>(CountingAllocator<NodeType>(&nodeBytes_), std::forward<Args>(args)...);
     }
 
     bool updateExistingNode(NodePtr node, const Value& value) 
@@ -101,7 +196,7 @@ private:
             evictLeastRecent();
         }
 
-        NodePtr newNode = std::make_shared<NodeType>(key, value);
+        NodePtr newNode = makeNode(key, value);
         mainCache_[key] = newNode;
         addToFront(newNode);
         return true;
@@ -137,13 +232,7 @@ private:
             return;
 
         removeFromMain(leastRecent);
-
-        if (ghostCache_.size() >= ghostCapacity_) 
-        {
-            removeOldestGhost();
-        }
-        addToGhost(leastRecent);
-
+        ghost_.insert(GhostFifo::fingerprint(leastRecent->getKey()));
         mainCache_.erase(leastRecent->getKey());
     }
 
@@ -153,49 +242,19 @@ private:
         node->next_->prev_ = node->prev_;
     }
 
-    void removeFromGhost(NodePtr node) 
-    {
-        node->prev_->next_ = node->next_;
-        node->next_->prev_ = node->prev_;
-    }
-
-    void addToGhost(NodePtr node) 
-    {
-        node->accessCount_ = 1;
-
-        node->next_ = ghostHead_->next_;
-        node->prev_ = ghostHead_;
-        ghostHead_->next_->prev_ = node;
-        ghostHead_->next_ = node;
-
-        ghostCache_[node->getKey()] = node;
-    }
-
-    void removeOldestGhost() 
-    {
-        NodePtr oldestGhost = ghostTail_->prev_;
-        if (oldestGhost == ghostHead_) 
-            return;
-
-        removeFromGhost(oldestGhost);
-        ghostCache_.erase(oldestGhost->getKey());
-    }
-    
-
 private:
     size_t capacity_;
-    size_t ghostCapacity_;
     size_t transformThreshold_;
     std::mutex mutex_;
 
+    // 计数器须先于使用它们的容器构造、晚于其析构
+    AllocationCounter indexBytes_{0};
+    AllocationCounter nodeBytes_{0};
     NodeMap mainCache_; 
-    NodeMap ghostCache_;
+    GhostFifo ghost_;
 
     NodePtr mainHead_;
     NodePtr mainTail_;
-
-    NodePtr ghostHead_;
-    NodePtr ghostTail_;
 };
 
 }
\ No newline at end of file
@@ -0,0 +1,208 @@
+#pragma once
+
+#include <atomic>
+#include <coroutine>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "HashCaches.h"
+#include "LruBase.h"
+
+namespace MyCache
+{
+
+// 协程接口的分片缓存：co_await getOrLoadAsync(key, loader) 命中时不挂起直接返回，
+// 未命中时挂起，同一 key 并发的加载合并为一次 loader 调用，加载完成后通过用户提供的 executor 恢复所有等待者。
+// loader 以回调方式异步完成：loader(key, done)，done(true, value) 表示成功，done(false, {}) 表示失败，可在任意线程调用。
+// loader 同步抛出异常时（此前不能已调用 done），异常从 co_await 处抛给发起加载的协程，合并等待的其他协程按失败恢复。
+template<typename Key, typename Value, typename CacheType = LruBase<Key, Value>>
+class HashAsyncCaches
+{
+public:
+    using LoadDone = std::function<void(bool, Value)>;
+    using Loader = std::function<void(const Key&, LoadDone)>;
+    using Executor = std::function<void(std::coroutine_handle<>)>;
+
+    struct Stats
+    {
+        uint64_t hits = 0;
+        uint64_t loads = 0;
+        uint64_t coalesced = 0;
+        uint64_t failures = 0;
+    };
+
+    class LoadAwaiter;
+
+    template<typename... Args>
+    HashAsyncCaches(size_t capacity, int sliceNum, Executor executor, Args... args)
+        : caches_(capacity, sliceNum, args...)
+        , executor_(std::move(executor))
+        , inflightShards_(caches_.sliceNum())
+    {}
+
+    void put(Key key, Value value) { caches_.put(key, value); }
+    bool get(Key key, Value& value) { return caches_.get(key, value); }
+    Value get(Key key) { return caches_.get(key); }
+    void remove(Key key) { caches_.remove(key); }
+
+    // 结果为 std::optional<Value>，加载失败时为空
+    LoadAwaiter getOrLoadAsync(Key key, Loader loader)
+    {
+        return LoadAwaiter(*this, std::move(key), std::move(loader));
+    }
+
+    Stats stats() const
+    {
+        return Stats{hits_, loads_, coalesced_, failures_};
+    }
+
+    class LoadAwaiter
+    {
+    public:
+        LoadAwaiter(HashAsyncCaches& owner, Key key, Loader loader)
+            : owner_(owner)
+            , key_(std::move(key))
+            , loader_(std::move(loader))
+        {}
+
+        bool await_ready()
+        {
+            if (!owner_.lookup(key_, result_))
+                return false;
+            ++owner_.hits_;
+            return true;
+        }
+
+        // loader 可能同步完成并经 executor 立即恢复本协程，调用 loader 之后不能再访问 this
+        bool await_suspend(std::coroutine_handle<> handle)
+        {
+            handle_ = handle;
+            HashAsyncCaches& owner = owner_;
+            InflightShard& shard = owner.inflightShards_[owner.caches_.sliceIndex(key_)];
+            {
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                // 加载完成时先写缓存再撤销在途记录，这里在锁内复查即可避免错过刚完成的加载
+                if (owner.lookup(key_, result_))
+                {
+                    ++owner.hits_;
+                    return false;
+                }
+                auto& waiters = shard.inflight[key_];
+                waiters.push_back(this);
+                if (waiters.size() > 1)
+                {
+                    ++owner.coalesced_;
+                    return true;
+                }
+            }
+
+            ++owner.loads_;
+            Key key = key_;
+            Loader loader = std::move(loader_);
+            LoadAwaiter* self = this;
+            try
+            {
+                loader(key, [&owner, key](bool ok, Value value) { owner.complete(key, ok, std::move(value)); });
+            }
+            catch (...)
+            {
+                owner.abandon(key, self);
+                throw;
+            }
+            return true;
+        }
+
+        std::optional<Value> await_resume() { return std::move(result_); }
+
+    private:
+        friend class HashAsyncCaches;
+
+        HashAsyncCaches&        owner_;
+        Key                     key_;
+        Loader                  loader_;
+        std::optional<Value>    result_;
+        std::coroutine_handle<> handle_;
+    };
+
+private:
+    struct InflightShard
+    {
+        std::mutex                                        mutex;
+        std::unordered_map<Key, std::vector<LoadAwaiter*>> inflight;
+    };
+
+    // 命中时把值直接写入 result，不需要 Value 可默认构造
+    bool lookup(const Key& key, std::optional<Value>& result)
+    {
+        caches_.mutate(key, [&](const Value* current) {
+            if (current)
+                result = *current;
+            return Mutation<Value>::keep();
+        });
+        return result.has_value();
+    }
+
+    // loader 抛出异常：撤销在途记录，发起者不再挂起（由异常返回），其余等待者按失败恢复
+    void abandon(const Key& key, LoadAwaiter* initiator)
+    {
+        ++failures_;
+        std::vector<LoadAwaiter*> waiters;
+        {
+            InflightShard& shard = inflightShards_[caches_.sliceIndex(key)];
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            auto it = shard.inflight.find(key);
+            if (it == shard.inflight.end())
+                return;
+            waiters.swap(it->second);
+            shard.inflight.erase(it);
+        }
+
+        for (LoadAwaiter* waiter : waiters)
+        {
+            if (waiter != initiator)
+                executor_(waiter->handle_);
+        }
+    }
+
+    void complete(const Key& key, bool ok, Value value)
+    {
+        if (ok)
+            caches_.put(key, value);
+        else
+            ++failures_;
+
+        std::vector<LoadAwaiter*> waiters;
+        {
+            InflightShard& shard = inflightShards_[caches_.sliceIndex(key)];
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            auto it = shard.inflight.find(key);
+            if (it == shard.inflight.end())
+                return;
+            waiters.swap(it->second);
+            shard.inflight.erase(it);
+        }
+
+        for (LoadAwaiter* waiter : waiters)
+        {
+            if (ok)
+                waiter->result_ = value;
+            executor_(waiter->handle_);
+        }
+    }
+
+private:
+    HashCaches<Key, Value, CacheType> caches_;
+    Executor                          executor_;
+    std::vector<InflightShard>        inflightShards_;
+    std::atomic<uint64_t>             hits_{0};
+    std::atomic<uint64_t>             loads_{0};
+    std::atomic<uint64_t>             coalesced_{0};
+    std::atomic<uint64_t>             failures_{0};
+};
+
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <algorithm>
+#include <iterator>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace MyCache
+{
+
+// 批量装载时输入的排列方式：默认越靠后越新（与 forEach 的遍历顺序一致）
+enum class BulkOrder { LeastRecentFirst, MostRecentFirst };
+
+// 在最多 threads 个线程上执行 fn(0) ... fn(count - 1)，threads 不大于 0 时取硬件线程数
+template<typename Fn>
+void parallelFor(size_t count, int threads, Fn fn)
+{
+    size_t workers = threads > 0 ? threads : std::max(1u, std::thread::hardware_concurrency());
+    workers = std::min(workers, count);
+    if (workers <= 1)
+    {
+        for (size_t i = 0; i < count; ++i)
+            fn(i);
+        return;
+    }
+
+    std::vector<std::thread> pool;
+    for (size_t w = 0; w < workers; ++w)
+    {
+        pool.emplace_back([&, w]() {
+            for (size_t i = w; i < count; i += workers)
+                fn(i);
+        });
+    }
+    for (auto& worker : pool)
+        worker.join();
+}
+
+// 并行地把 entries（随机访问区间，元素带 first / second）按 shardOf(key) 划分到各分片，
+// 每个分片得到元素指针，按最近使用在前排列；同一分片内保持输入中的相对顺序。
+template<typename Range, typename ShardOf>
+auto partitionForBulk(const Range& entries, size_t shardCount, ShardOf shardOf, BulkOrder order, int threads)
+{
+    using Entry = std::remove_reference_t<decltype(*std::begin(entries))>;
+    auto first = std::begin(entries);
+    size_t total = std::distance(first, std::end(entries));
+    size_t chunks = threads > 0 ? threads : std::max(1u, std::thread::hardware_concurrency());
+    chunks = std::max<size_t>(1, std::min(chunks, total / 4096 + 1));
+    size_t chunkSize = (total + chunks - 1) / chunks;
+
+    // 先按输入分块各自划分，再按块号顺序拼接，保证分片内顺序与输入一致
+    std::vector<std::vector<std::vector<const Entry*>>> local(chunks, std::vector<std::vector<const Entry*>>(shardCount));
+    parallelFor(chunks, threads, [&](size_t c) {
+        size_t begin = c * chunkSize;
+        size_t end = std::min(total, begin + chunkSize);
+        for (size_t i = begin; i < end; ++i)
+        {
+            const Entry& entry = *(first + i);
+            local[c][shardOf(entry.first)].push_back(&entry);
+        }
+    });
+
+    std::vector<std::vector<const Entry*>> shards(shardCount);
+    parallelFor(shardCount, threads, [&](size_t s) {
+        size_t size = 0;
+        for (size_t c = 0; c < chunks; ++c)
+            size += local[c][s].size();
+        shards[s].reserve(size);
+        for (size_t c = 0; c < chunks; ++c)
+        {
+            shards[s].insert(shards[s].end(), local[c][s].begin(), local[c][s].end());
+            std::vector<const Entry*>().swap(local[c][s]);
+        }
+        if (order == BulkOrder::LeastRecentFirst)
+            std::reverse(shards[s].begin(), shards[s].end());
+    });
+    return shards;
+}
+
+}
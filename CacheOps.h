@@ -0,0 +1,89 @@
+#pragma once
+
+#include <optional>
+#include <utility>
+
+namespace MyCache
+{
+
+// mutate 的回调结果：保留现状、写入新值或删除条目
+template<typename Value>
+struct Mutation
+{
+    enum class Kind { Keep, Set, Remove };
+
+    Kind  kind;
+    Value value;
+
+    static Mutation keep() { return Mutation{Kind::Keep, Value{}}; }
+    static Mutation set(Value value) { return Mutation{Kind::Set, std::move(value)}; }
+    static Mutation remove() { return Mutation{Kind::Remove, Value{}}; }
+};
+
+// 原子读改写操作。策略（及分片包装）实现底层原语 mutate(key, fn)：在一次加锁内把当前值
+// （不存在时为 nullptr）交给 fn，再按返回的 Mutation 处理；Keep 且条目存在时按一次读访问更新最近/频率信息，
+// Set 与普通 put 走同样的更新/淘汰路径。回调在分片锁内执行，不能再访问同一个缓存。
+template<typename Derived, typename Key, typename Value>
+class CacheOps
+{
+public:
+    // fn(const Value* current) -> std::optional<Value>，返回值写入缓存，返回空则删除；结果为新值
+    template<typename Fn>
+    std::optional<Value> compute(Key key, Fn fn)
+    {
+        std::optional<Value> result;
+        derived().mutate(key, [&](const Value* current) {
+            result = fn(current);
+            if (result)
+                return Mutation<Value>::set(*result);
+            return current ? Mutation<Value>::remove() : Mutation<Value>::keep();
+        });
+        return result;
+    }
+
+    // 仅在 key 存在时调用 fn(const Value&) -> std::optional<Value>
+    template<typename Fn>
+    std::optional<Value> computeIfPresent(Key key, Fn fn)
+    {
+        std::optional<Value> result;
+        derived().mutate(key, [&](const Value* current) {
+            if (!current)
+                return Mutation<Value>::keep();
+            result = fn(*current);
+            return result ? Mutation<Value>::set(*result) : Mutation<Value>::remove();
+        });
+        return result;
+    }
+
+    // key 不存在时写入 value，存在时写入 fn(old, value)；fn 返回空则删除
+    template<typename Fn>
+    std::optional<Value> merge(Key key, const Value& value, Fn fn)
+    {
+        std::optional<Value> result;
+        derived().mutate(key, [&](const Value* current) {
+            result = current ? fn(*current, value) : std::optional<Value>(value);
+            if (result)
+                return Mutation<Value>::set(*result);
+            return current ? Mutation<Value>::remove() : Mutation<Value>::keep();
+        });
+        return result;
+    }
+
+    // 当前值等于 expected 时替换为 desired；key 不存在时失败
+    bool compareAndSet(Key key, const Value& expected, const Value& desired)
+    {
+        bool swapped = false;
+        derived().mutate(key, [&](const Value* current) {
+            if (!current || !(*current == expected))
+                return Mutation<Value>::keep();
+            swapped = true;
+            return Mutation<Value>::set(desired);
+        });
+        return swapped;
+    }
+
+private:
+    Derived& derived() { return static_cast<Derived&>(*this); }
+};
+
+}
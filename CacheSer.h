@@ -7,7 +7,7 @@ template <typename Key, typename Value>
 class CacheSer
 {
 public:
-    virtual ~KICachePolicy() {};
+    virtual ~CacheSer() {};
 
     virtual void put(Key key, Value value) = 0;
 
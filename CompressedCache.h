@@ -0,0 +1,150 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "HashCaches.h"
+#include "LruBase.h"
+#include "LzCodec.h"
+
+namespace MyCache
+{
+
+struct CompressedValue
+{
+    std::shared_ptr<const std::string> data;
+    uint32_t                           rawSize = 0;
+    bool                               compressed = false;
+};
+
+// 以存储字节数（压缩后大小）计费的 LRU 分片
+template<typename Key>
+class CompressedLruCache : public LruBase<Key, CompressedValue>
+{
+public:
+    using LruBase<Key, CompressedValue>::LruBase;
+
+protected:
+    size_t charge(const CompressedValue& value) const override
+    {
+        return value.data ? value.data->size() + 1 : 1;
+    }
+};
+
+// 可选的透明压缩层：超过阈值的值在 put 时压缩（在分片锁外完成），
+// get 在锁内只拷贝共享指针，解压同样在锁外进行。capacity 以存储字节计。
+template<typename Key>
+class HashCompressedCaches
+{
+public:
+    struct Stats
+    {
+        uint64_t puts = 0;
+        uint64_t compressedPuts = 0;
+        uint64_t rawBytes = 0;
+        uint64_t storedBytes = 0;
+        uint64_t compressNanos = 0;
+        uint64_t decompressCount = 0;
+        uint64_t decompressNanos = 0;
+
+        double ratio() const { return storedBytes ? static_cast<double>(rawBytes) / storedBytes : 1.0; }
+    };
+
+    HashCompressedCaches(size_t capacityBytes, int sliceNum, size_t threshold = 1024)
+        : caches_(capacityBytes, sliceNum)
+        , threshold_(threshold)
+    {}
+
+    void put(Key key, std::string_view value)
+    {
+        CompressedValue stored;
+        stored.rawSize = static_cast<uint32_t>(value.size());
+        if (value.size() >= threshold_)
+        {
+            auto start = std::chrono::steady_clock::now();
+            auto compressed = std::make_shared<std::string>();
+            LzCodec::compress(value, *compressed);
+            compressNanos_ += elapsedNanos(start);
+            if (compressed->size() < value.size())
+            {
+                stored.data = std::move(compressed);
+                stored.compressed = true;
+                ++compressedPuts_;
+            }
+        }
+        if (!stored.data)
+            stored.data = std::make_shared<const std::string>(value);
+
+        ++puts_;
+        rawBytes_ += value.size();
+        storedBytes_ += stored.data->size();
+        caches_.put(key, std::move(stored));
+    }
+
+    bool get(Key key, std::string& value)
+    {
+        CompressedValue stored;
+        if (!caches_.get(key, stored) || !stored.data)
+            return false;
+
+        if (!stored.compressed)
+        {
+            value = *stored.data;
+            return true;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        bool ok = LzCodec::decompress(*stored.data, stored.rawSize, value);
+        decompressNanos_ += elapsedNanos(start);
+        ++decompressCount_;
+        return ok;
+    }
+
+    std::string get(Key key)
+    {
+        std::string value;
+        get(key, value);
+        return value;
+    }
+
+    void remove(Key key)
+    {
+        caches_.remove(key);
+    }
+
+    Stats stats() const
+    {
+        Stats stats;
+        stats.puts = puts_;
+        stats.compressedPuts = compressedPuts_;
+        stats.rawBytes = rawBytes_;
+        stats.storedBytes = storedBytes_;
+        stats.compressNanos = compressNanos_;
+        stats.decompressCount = decompressCount_;
+        stats.decompressNanos = decompressNanos_;
+        return stats;
+    }
+
+private:
+    static uint64_t elapsedNanos(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count();
+    }
+
+private:
+    HashCaches<Key, CompressedValue, CompressedLruCache<Key>> caches_;
+    size_t                                                    threshold_;
+    std::atomic<uint64_t>                                     puts_{0};
+    std::atomic<uint64_t>                                     compressedPuts_{0};
+    std::atomic<uint64_t>                                     rawBytes_{0};
+    std::atomic<uint64_t>                                     storedBytes_{0};
+    std::atomic<uint64_t>                                     compressNanos_{0};
+    std::atomic<uint64_t>                                     decompressCount_{0};
+    std::atomic<uint64_t>                                     decompressNanos_{0};
+};
+
+}
@@ -0,0 +1,237 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "CacheSer.h"
+#include "EpochReclaim.h"
+
+namespace MyCache
+{
+
+// 读多写少场景的近似LRU：get 不加锁，沿原子指针遍历哈希桶；
+// put/remove 串行化在写锁内，被覆盖或淘汰的节点交给 EpochDomain 延迟释放。
+// 访问只置位引用标记，淘汰时由写者按 CLOCK 扫描补做近似的最近使用维护。
+template<typename Key, typename Value>
+class EpochLruCache : public CacheSer<Key, Value>
+{
+private:
+    struct Node
+    {
+        const Key            key_;
+        const Value          value_;
+        const size_t         hash_;
+        size_t               clockSlot_;
+        std::atomic<Node*>   next_;
+        std::atomic<uint8_t> referenced_;
+
+        Node(const Key& key, const Value& value, size_t hash, size_t clockSlot)
+            : key_(key)
+            , value_(value)
+            , hash_(hash)
+            , clockSlot_(clockSlot)
+            , next_(nullptr)
+            , referenced_(1)
+        {}
+    };
+
+public:
+    explicit EpochLruCache(int capacity)
+        : capacity_(capacity > 0 ? capacity : 0)
+        , bucketMask_(bucketCountFor(capacity_) - 1)
+        , buckets_(new std::atomic<Node*>[bucketMask_ + 1])
+        , clock_(capacity_, nullptr)
+        , hand_(0)
+        , size_(0)
+    {
+        for (size_t i = 0; i <= bucketMask_; ++i)
+            buckets_[i].store(nullptr, std::memory_order_relaxed);
+        freeSlots_.reserve(capacity_);
+        for (size_t i = capacity_; i > 0; --i)
+            freeSlots_.push_back(i - 1);
+    }
+
+    ~EpochLruCache() override
+    {
+        for (size_t i = 0; i <= bucketMask_; ++i)
+        {
+            Node* node = buckets_[i].load(std::memory_order_relaxed);
+            while (node)
+            {
+                Node* next = node->next_.load(std::memory_order_relaxed);
+                delete node;
+                node = next;
+            }
+        }
+    }
+
+    void put(Key key, Value value) override
+    {
+        if (capacity_ == 0)
+            return;
+
+        size_t hash = hashOf(key);
+        std::lock_guard<std::mutex> lock(writeMutex_);
+        std::atomic<Node*>* link = findLink(key, hash);
+        if (Node* old = link->load(std::memory_order_relaxed))
+        {
+            replaceNode(link, old, value);
+        }
+        else
+        {
+            addNewNode(key, value, hash);
+        }
+
+        if (epoch_.pending() >= kReclaimBatch)
+            epoch_.reclaim();
+    }
+
+    bool get(Key key, Value& value) override
+    {
+        size_t hash = hashOf(key);
+        auto guard = epoch_.pin();
+        Node* node = buckets_[hash & bucketMask_].load(std::memory_order_acquire);
+        for (; node; node = node->next_.load(std::memory_order_acquire))
+        {
+            if (node->hash_ == hash && node->key_ == key)
+            {
+                if (!node->referenced_.load(std::memory_order_relaxed))
+                    node->referenced_.store(1, std::memory_order_relaxed);
+                value = node->value_;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    Value get(Key key) override
+    {
+        Value value{};
+        get(key, value);
+        return value;
+    }
+
+    void remove(Key key)
+    {
+        size_t hash = hashOf(key);
+        std::lock_guard<std::mutex> lock(writeMutex_);
+        std::atomic<Node*>* link = findLink(key, hash);
+        if (Node* node = link->load(std::memory_order_relaxed))
+        {
+            unlinkNode(link, node);
+        }
+
+        if (epoch_.pending() >= kReclaimBatch)
+            epoch_.reclaim();
+    }
+
+    size_t size()
+    {
+        std::lock_guard<std::mutex> lock(writeMutex_);
+        return size_;
+    }
+
+private:
+    static constexpr size_t kReclaimBatch = 64;
+
+    static size_t bucketCountFor(size_t capacity)
+    {
+        size_t count = 1;
+        while (count < capacity)
+            count <<= 1;
+        return count;
+    }
+
+    static size_t hashOf(const Key& key)
+    {
+        size_t hash = std::hash<Key>{}(key);
+        hash ^= hash >> 33;
+        hash *= 0xff51afd7ed558ccdULL;
+        hash ^= hash >> 33;
+        return hash;
+    }
+
+    // 返回指向目标节点的链接；未找到时返回链尾的空链接
+    std::atomic<Node*>* findLink(const Key& key, size_t hash)
+    {
+        std::atomic<Node*>* link = &buckets_[hash & bucketMask_];
+        for (Node* node = link->load(std::memory_order_relaxed); node;
+             node = link->load(std::memory_order_relaxed))
+        {
+            if (node->hash_ == hash && node->key_ == key)
+                return link;
+            link = &node->next_;
+        }
+        return link;
+    }
+
+    void replaceNode(std::atomic<Node*>* link, Node* old, const Value& value)
+    {
+        Node* node = new Node(old->key_, value, old->hash_, old->clockSlot_);
+        node->next_.store(old->next_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        link->store(node, std::memory_order_release);
+        clock_[node->clockSlot_] = node;
+        epoch_.retire(old);
+    }
+
+    void addNewNode(const Key& key, const Value& value, size_t hash)
+    {
+        if (size_ >= capacity_)
+        {
+            evictOne();
+        }
+
+        size_t slot = freeSlots_.back();
+        freeSlots_.pop_back();
+
+        std::atomic<Node*>& bucket = buckets_[hash & bucketMask_];
+        Node* node = new Node(key, value, hash, slot);
+        node->next_.store(bucket.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        bucket.store(node, std::memory_order_release);
+        clock_[slot] = node;
+        ++size_;
+    }
+
+    void unlinkNode(std::atomic<Node*>* link, Node* node)
+    {
+        link->store(node->next_.load(std::memory_order_relaxed), std::memory_order_release);
+        clock_[node->clockSlot_] = nullptr;
+        freeSlots_.push_back(node->clockSlot_);
+        --size_;
+        epoch_.retire(node);
+    }
+
+    void evictOne()
+    {
+        while (true)
+        {
+            Node* node = clock_[hand_];
+            hand_ = (hand_ + 1) % capacity_;
+            if (!node)
+                continue;
+            if (node->referenced_.load(std::memory_order_relaxed))
+            {
+                node->referenced_.store(0, std::memory_order_relaxed);
+                continue;
+            }
+
+            unlinkNode(findLink(node->key_, node->hash_), node);
+            return;
+        }
+    }
+
+private:
+    size_t                                 capacity_;
+    size_t                                 bucketMask_;
+    std::unique_ptr<std::atomic<Node*>[]>  buckets_;
+    std::vector<Node*>                     clock_;
+    std::vector<size_t>                    freeSlots_;
+    size_t                                 hand_;
+    size_t                                 size_;
+    std::mutex                             writeMutex_;
+    EpochDomain                            epoch_;
+};
+
+}
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace MyCache
+{
+
+// 全局线程槽位表：线程第一次进入读临界区时领取槽位，线程退出时归还。
+// 槽位用完后领到 kNoSlot，这些线程走 EpochDomain 的加锁慢路径
+class EpochThreadRegistry
+{
+public:
+    static constexpr size_t kMaxThreads = 256;
+    static constexpr size_t kNoSlot = ~size_t(0);
+
+    static size_t slot()
+    {
+        thread_local SlotHolder holder;
+        return holder.index_;
+    }
+
+private:
+    struct SlotHolder
+    {
+        size_t index_;
+        SlotHolder() : index_(acquire()) {}
+        ~SlotHolder()
+        {
+            if (index_ != kNoSlot)
+                used()[index_].store(false, std::memory_order_release);
+        }
+    };
+
+    static std::atomic<bool>* used()
+    {
+        static std::atomic<bool> used[kMaxThreads] = {};
+        return used;
+    }
+
+    static size_t acquire()
+    {
+        for (size_t i = 0; i < kMaxThreads; ++i)
+        {
+            bool expected = false;
+            if (used()[i].compare_exchange_strong(expected, true))
+                return i;
+        }
+        return kNoSlot;
+    }
+};
+
+// 基于纪元的延迟回收：读者进入临界区时登记当前纪元，写者摘除的节点先挂到退休队列，
+// 等所有活跃读者都越过退休时的纪元两代之后再真正释放。
+// retire/reclaim 由写者在持有写锁时调用，pin 可在任意线程无锁调用；
+// 没有领到槽位的线程在 overflowMutex_ 下登记纪元，推进纪元时一并检查。
+class EpochDomain
+{
+public:
+    class Guard
+    {
+    public:
+        explicit Guard(std::atomic<uint64_t>& slot) : slot_(&slot) {}
+        Guard(EpochDomain& domain, uint64_t epoch) : domain_(&domain), epoch_(epoch) {}
+        Guard(Guard&& other) noexcept : slot_(other.slot_), domain_(other.domain_), epoch_(other.epoch_)
+        {
+            other.slot_ = nullptr;
+            other.domain_ = nullptr;
+        }
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+        ~Guard()
+        {
+            if (slot_)
+                slot_->store(kInactive, std::memory_order_release);
+            if (domain_)
+                domain_->unpinOverflow(epoch_);
+        }
+
+    private:
+        std::atomic<uint64_t>* slot_ = nullptr;
+        EpochDomain*           domain_ = nullptr;
+        uint64_t               epoch_ = 0;
+    };
+
+    EpochDomain()
+        : globalEpoch_(1)
+        , slots_(new Slot[EpochThreadRegistry::kMaxThreads])
+    {}
+
+    ~EpochDomain()
+    {
+        for (auto& retired : retired_)
+            retired.deleter(retired.ptr);
+    }
+
+    Guard pin()
+    {
+        size_t index = EpochThreadRegistry::slot();
+        if (index == EpochThreadRegistry::kNoSlot)
+            return pinOverflow();
+        std::atomic<uint64_t>& slot = slots_[index].epoch;
+        slot.store(globalEpoch_.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+        return Guard(slot);
+    }
+
+    template<typename T>
+    void retire(T* ptr)
+    {
+        retired_.push_back({ptr, [](void* p) { delete static_cast<T*>(p); },
+                             globalEpoch_.load(std::memory_order_relaxed)});
+    }
+
+    size_t pending() const { return retired_.size(); }
+
+    void reclaim()
+    {
+        tryAdvance();
+        uint64_t current = globalEpoch_.load(std::memory_order_acquire);
+        while (!retired_.empty() && retired_.front().epoch + 2 <= current)
+        {
+            retired_.front().deleter(retired_.front().ptr);
+            retired_.pop_front();
+        }
+    }
+
+private:
+    static constexpr uint64_t kInactive = 0;
+
+    struct alignas(64) Slot
+    {
+        std::atomic<uint64_t> epoch{kInactive};
+    };
+
+    struct Retired
+    {
+        void* ptr;
+        void (*deleter)(void*);
+        uint64_t epoch;
+    };
+
+    // 慢路径：在锁内读取纪元并登记，推进纪元也在同一把锁内检查，登记与推进不会交错
+    Guard pinOverflow()
+    {
+        std::lock_guard<std::mutex> lock(overflowMutex_);
+        uint64_t epoch = globalEpoch_.load(std::memory_order_seq_cst);
+        ++overflow_[epoch];
+        return Guard(*this, epoch);
+    }
+
+    void unpinOverflow(uint64_t epoch)
+    {
+        std::lock_guard<std::mutex> lock(overflowMutex_);
+        auto it = overflow_.find(epoch);
+        if (--it->second == 0)
+            overflow_.erase(it);
+    }
+
+    bool tryAdvance()
+    {
+        uint64_t current = globalEpoch_.load(std::memory_order_seq_cst);
+        for (size_t i = 0; i < EpochThreadRegistry::kMaxThreads; ++i)
+        {
+            uint64_t epoch = slots_[i].epoch.load(std::memory_order_seq_cst);
+            if (epoch != kInactive && epoch != current)
+                return false;
+        }
+        std::lock_guard<std::mutex> lock(overflowMutex_);
+        if (!overflow_.empty() && (overflow_.size() > 1 || overflow_.begin()->first != current))
+            return false;
+        globalEpoch_.store(current + 1, std::memory_order_seq_cst);
+        return true;
+    }
+
+private:
+    std::atomic<uint64_t>      globalEpoch_;
+    std::unique_ptr<Slot[]>    slots_;
+    std::deque<Retired>        retired_;
+    std::mutex                 overflowMutex_;
+    std::map<uint64_t, size_t> overflow_;
+};
+
+}
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace MyCache
+{
+
+enum class EvictionCause
+{
+    Capacity,   // 容量不足被淘汰
+    Explicit,   // 调用 remove
+    Replaced,   // put 覆盖旧值
+    Expired     // 过期
+};
+
+template<typename Key, typename Value>
+struct EvictionEvent
+{
+    Key           key;
+    Value         value;
+    EvictionCause cause;
+};
+
+template<typename Key, typename Value>
+using EvictionListener = std::function<void(const std::vector<EvictionEvent<Key, Value>>&)>;
+
+// 每个分片一份的淘汰通知缓冲：record 在分片锁内调用，只把事件追加到预留好容量的 active_；
+// deliver 在分片锁外调用，持锁交换双缓冲后在锁外批量回调，回调结束后 clear 保留容量，稳定状态下不再分配。
+// 回调内部可以重新访问缓存，嵌套产生的事件由外层 deliver 循环继续投递。
+// active_ 不设上限：回调执行期间其他线程产生的事件都会追加进来，回调跟不上淘汰速度时会扩容；
+// 投递完后超过 batchSize_ 若干倍的缓冲会被释放，不会一直占着峰值时的内存。
+template<typename Key, typename Value>
+class EvictionBuffer
+{
+public:
+    using Event = EvictionEvent<Key, Value>;
+
+    explicit EvictionBuffer(size_t batchSize = 64)
+        : batchSize_(batchSize)
+        , enabled_(false)
+    {}
+
+    // 需持有分片锁
+    void setListener(EvictionListener<Key, Value> listener)
+    {
+        listener_ = std::make_shared<EvictionListener<Key, Value>>(std::move(listener));
+        enabled_.store(static_cast<bool>(*listener_), std::memory_order_release);
+        if (enabled_.load(std::memory_order_relaxed))
+        {
+            active_.reserve(batchSize_);
+            delivering_.reserve(batchSize_);
+        }
+        else
+        {
+            active_.clear();
+        }
+    }
+
+    bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    // 需持有分片锁；value 会被移走，调用方之后不能再使用。未设置监听器时直接返回
+    void record(const Key& key, Value& value, EvictionCause cause)
+    {
+        if (!enabled())
+            return;
+        active_.push_back(Event{key, std::move(value), cause});
+    }
+
+    // 不能持有分片锁。拿不到 deliverMutex_ 时交给正在投递的线程；后者释放 deliverMutex_ 后
+    // 会再检查一次 active_，避免在它判空之后、释放之前记入的事件无人投递。
+    // 在本缓冲的回调里重入时本线程已持有 deliverMutex_，直接返回，由外层 drain 继续投递
+    void deliver(std::mutex& sliceMutex)
+    {
+        if (!enabled() || deliveringOnThisThread())
+            return;
+
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> deliverLock(deliverMutex_, std::try_to_lock);
+                if (!deliverLock.owns_lock())
+                    return;
+                drain(sliceMutex);
+            }
+            std::lock_guard<std::mutex> lock(sliceMutex);
+            if (active_.empty())
+                return;
+        }
+    }
+
+private:
+    // 本线程正在投递的缓冲，回调里可能再进入其他分片，因此按栈记录
+    struct DeliverFrame
+    {
+        const EvictionBuffer* buffer;
+        DeliverFrame*         prev;
+    };
+
+    static DeliverFrame*& deliverTop()
+    {
+        static thread_local DeliverFrame* top = nullptr;
+        return top;
+    }
+
+    bool deliveringOnThisThread() const
+    {
+        for (DeliverFrame* frame = deliverTop(); frame; frame = frame->prev)
+        {
+            if (frame->buffer == this)
+                return true;
+        }
+        return false;
+    }
+
+    // 需持有 deliverMutex_
+    void drain(std::mutex& sliceMutex)
+    {
+        DeliverFrame frame{this, deliverTop()};
+        deliverTop() = &frame;
+        struct PopFrame
+        {
+            DeliverFrame& frame;
+            ~PopFrame() { deliverTop() = frame.prev; }
+        } pop{frame};
+
+        while (true)
+        {
+            std::shared_ptr<EvictionListener<Key, Value>> listener;
+            {
+                std::lock_guard<std::mutex> lock(sliceMutex);
+                if (active_.empty())
+                    return;
+                active_.swap(delivering_);
+                listener = listener_;
+            }
+            if (listener && *listener)
+                (*listener)(delivering_);
+            delivering_.clear();
+            if (delivering_.capacity() > kShrinkFactor * batchSize_)
+            {
+                std::vector<Event>().swap(delivering_);
+                delivering_.reserve(batchSize_);
+            }
+        }
+    }
+
+private:
+    static constexpr size_t                       kShrinkFactor = 16;
+
+    size_t                                        batchSize_;
+    std::atomic<bool>                             enabled_;
+    std::shared_ptr<EvictionListener<Key, Value>> listener_;
+    std::vector<Event>                            active_;
+    std::vector<Event>                            delivering_;
+    std::mutex                                    deliverMutex_;
+};
+
+}
@@ -0,0 +1,690 @@
+#pragma once
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "HashCaches.h"
+#include "LruBase.h"
+
+namespace MyCache
+{
+
+// 文件层的序列化方式：std::string 原样写入，平凡可拷贝类型按字节写入
+template<typename T, typename Enable = void>
+struct TierCodec;
+
+template<>
+struct TierCodec<std::string>
+{
+    static void encode(const std::string& value, std::string& out) { out.append(value); }
+    static bool decode(std::string_view in, std::string& value)
+    {
+        value.assign(in);
+        return true;
+    }
+};
+
+template<typename T>
+struct TierCodec<T, std::enable_if_t<std::is_trivially_copyable_v<T>>>
+{
+    static void encode(const T& value, std::string& out)
+    {
+        out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+    static bool decode(std::string_view in, T& value)
+    {
+        if (in.size() != sizeof(T))
+            return false;
+        std::memcpy(&value, in.data(), sizeof(T));
+        return true;
+    }
+};
+
+// 本地文件二级存储：被内存淘汰的条目先进入 pending_，由后台线程批量追加到日志段文件，
+// 内存中只保留 key -> (段号, 偏移, 长度) 的索引。读取在锁外用 pread 完成。
+// 活跃数据占比低于 compactRatio 的旧段会被后台线程重写到当前段后删除。
+// 索引只存在于内存，构造时会清理目录中本类遗留的 tier-<编号>.seg 段文件，其他文件不受影响。
+// 每个 key 按散列落入一个计数槽，记录其在 pending_ / inflight_ / index_ 中的条目数，槽为 0 时 erase 无需加锁。
+// 槽上另有版本号，append / erase 改变其中任一 key 的值时递增，供调用方在锁外读取后校验。
+// 写文件失败的批次放回 pending_ 等待重试，失败次数记入 writeErrors。
+template<typename Key, typename Value>
+class FileTier
+{
+public:
+    struct Stats
+    {
+        size_t   segments = 0;
+        uint64_t fileBytes = 0;
+        uint64_t liveBytes = 0;
+        size_t   indexEntries = 0;
+        size_t   pendingEntries = 0;
+        uint64_t appended = 0;
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t compactions = 0;
+        uint64_t writeErrors = 0;
+    };
+
+    explicit FileTier(const std::string& dir, uint64_t segmentBytes = 64 << 20,
+                      double compactRatio = 0.5, size_t batchSize = 256)
+        : dir_(dir)
+        , segmentBytes_(segmentBytes)
+        , compactRatio_(compactRatio)
+        , batchSize_(batchSize)
+        , nextSegmentId_(0)
+        , stop_(false)
+        , flushRequested_(false)
+    {
+        std::filesystem::create_directories(dir_);
+        for (const auto& entry : std::filesystem::directory_iterator(dir_))
+        {
+            if (isSegmentFile(entry.path()))
+                std::filesystem::remove(entry.path());
+        }
+        openSegment();
+        writer_ = std::thread([this]() { writerLoop(); });
+    }
+
+    ~FileTier()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        writerCv_.notify_all();
+        writer_.join();
+    }
+
+    FileTier(const FileTier&) = delete;
+    FileTier& operator=(const FileTier&) = delete;
+
+    // 异步追加；同一 key 在落盘前的多次写入只保留最后一次
+    void append(const Key& key, const Value& value)
+    {
+        bool wake;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (pending_.insert_or_assign(key, value).second)
+                track(key, 1);
+            bump(key);
+            wake = pending_.size() >= batchSize_;
+        }
+        if (wake)
+            writerCv_.notify_one();
+    }
+
+    // version 不为空时返回读取时该 key 所在槽的版本号
+    bool lookup(const Key& key, Value& value, uint64_t* version = nullptr)
+    {
+        std::shared_ptr<Segment> segment;
+        Location location;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (version)
+                *version = versions_[presenceSlot(key)].load(std::memory_order_relaxed);
+            if (findPending(key, value))
+            {
+                ++hits_;
+                return true;
+            }
+            auto it = index_.find(key);
+            if (it == index_.end())
+            {
+                ++misses_;
+                return false;
+            }
+            location = it->second;
+            segment = segments_[location.segment];
+        }
+
+        std::string record(location.length, '\0');
+        if (::pread(segment->fd, record.data(), location.length, location.offset)
+                != static_cast<ssize_t>(location.length)
+            || !decodeRecord(record, key, value))
+        {
+            ++misses_;
+            return false;
+        }
+        ++hits_;
+        return true;
+    }
+
+    // 文件层中没有该 key 时不加锁直接返回，内存层的每次写入都会调用
+    void erase(const Key& key)
+    {
+        if (presence_[presenceSlot(key)].load(std::memory_order_acquire) == 0)
+            return;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        eraseLocked(key);
+    }
+
+    // 槽版本号仍等于 version（lookup 之后没有新的写入或删除）时才删除
+    void eraseIfUnchanged(const Key& key, uint64_t version)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (versions_[presenceSlot(key)].load(std::memory_order_relaxed) == version)
+            eraseLocked(key);
+    }
+
+    uint64_t version(const Key& key) const
+    {
+        return versions_[presenceSlot(key)].load(std::memory_order_acquire);
+    }
+
+    // 阻塞直到当前所有 pending 条目都已写入文件；期间写文件失败时返回 false
+    bool flush()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        uint64_t errors = writeErrors_;
+        flushRequested_ = true;
+        writerCv_.notify_one();
+        flushedCv_.wait(lock, [&]() {
+            return (pending_.empty() && inflight_.empty()) || stop_ || writeErrors_ != errors;
+        });
+        return writeErrors_ == errors;
+    }
+
+    Stats stats()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Stats stats;
+        stats.segments = segments_.size();
+        for (const auto& [id, segment] : segments_)
+        {
+            stats.fileBytes += segment->size;
+            stats.liveBytes += segment->liveBytes;
+        }
+        stats.indexEntries = index_.size();
+        stats.pendingEntries = pending_.size() + inflight_.size();
+        stats.appended = appended_;
+        stats.hits = hits_;
+        stats.misses = misses_;
+        stats.compactions = compactions_;
+        stats.writeErrors = writeErrors_;
+        return stats;
+    }
+
+private:
+    struct Segment
+    {
+        int      fd = -1;
+        uint32_t id = 0;
+        uint64_t size = 0;
+        uint64_t liveBytes = 0;
+        std::filesystem::path path;
+
+        ~Segment()
+        {
+            if (fd >= 0)
+                ::close(fd);
+            if (removeOnClose)
+                std::filesystem::remove(path);
+        }
+
+        bool removeOnClose = false;
+    };
+
+    struct Location
+    {
+        uint32_t segment;
+        uint32_t length;
+        uint64_t offset;
+    };
+
+    struct RecordHeader
+    {
+        uint32_t keyLength;
+        uint32_t valueLength;
+    };
+
+    static constexpr int kPresenceBits = 12;
+
+    static size_t presenceSlot(const Key& key)
+    {
+        uint64_t h = static_cast<uint64_t>(std::hash<Key>{}(key)) * 0x9E3779B97F4A7C15ULL;
+        return static_cast<size_t>(h >> (64 - kPresenceBits));
+    }
+
+    // 需持有 mutex_
+    void track(const Key& key, int delta)
+    {
+        presence_[presenceSlot(key)].fetch_add(static_cast<uint32_t>(delta), std::memory_order_release);
+    }
+
+    // 需持有 mutex_
+    void bump(const Key& key)
+    {
+        versions_[presenceSlot(key)].fetch_add(1, std::memory_order_release);
+    }
+
+    // 需持有 mutex_
+    void eraseLocked(const Key& key)
+    {
+        size_t removed = pending_.erase(key) + inflight_.erase(key);
+        auto it = index_.find(key);
+        if (it != index_.end())
+        {
+            segments_[it->second.segment]->liveBytes -= it->second.length;
+            index_.erase(it);
+            ++removed;
+        }
+        if (removed)
+        {
+            track(key, -static_cast<int>(removed));
+            bump(key);
+        }
+    }
+
+    // 只识别本类创建的段文件：tier-<编号>.seg
+    static bool isSegmentFile(const std::filesystem::path& path)
+    {
+        std::string name = path.filename().string();
+        const std::string prefix = "tier-";
+        const std::string suffix = ".seg";
+        if (name.size() <= prefix.size() + suffix.size()
+            || name.compare(0, prefix.size(), prefix) != 0
+            || name.compare(name.size() - suffix.size(), suffix.size(), suffix) != 0)
+            return false;
+        for (size_t i = prefix.size(); i < name.size() - suffix.size(); ++i)
+        {
+            if (name[i] < '0' || name[i] > '9')
+                return false;
+        }
+        return true;
+    }
+
+    bool findPending(const Key& key, Value& value)
+    {
+        auto it = pending_.find(key);
+        if (it != pending_.end())
+        {
+            value = it->second;
+            return true;
+        }
+        auto inflight = inflight_.find(key);
+        if (inflight != inflight_.end())
+        {
+            value = inflight->second;
+            return true;
+        }
+        return false;
+    }
+
+    static void encodeRecord(const Key& key, const Value& value, std::string& out)
+    {
+        size_t start = out.size();
+        out.resize(start + sizeof(RecordHeader));
+        TierCodec<Key>::encode(key, out);
+        size_t keyEnd = out.size();
+        TierCodec<Value>::encode(value, out);
+        RecordHeader header{static_cast<uint32_t>(keyEnd - start - sizeof(RecordHeader)),
+                            static_cast<uint32_t>(out.size() - keyEnd)};
+        std::memcpy(&out[start], &header, sizeof(header));
+    }
+
+    static bool parseRecord(std::string_view record, std::string_view& keyBytes, std::string_view& valueBytes)
+    {
+        RecordHeader header;
+        if (record.size() < sizeof(header))
+            return false;
+        std::memcpy(&header, record.data(), sizeof(header));
+        if (record.size() < sizeof(header) + header.keyLength + header.valueLength)
+            return false;
+        keyBytes = record.substr(sizeof(header), header.keyLength);
+        valueBytes = record.substr(sizeof(header) + header.keyLength, header.valueLength);
+        return true;
+    }
+
+    static bool decodeRecord(std::string_view record, const Key& key, Value& value)
+    {
+        std::string_view keyBytes;
+        std::string_view valueBytes;
+        Key storedKey{};
+        return parseRecord(record, keyBytes, valueBytes)
+            && TierCodec<Key>::decode(keyBytes, storedKey) && storedKey == key
+            && TierCodec<Value>::decode(valueBytes, value);
+    }
+
+    // 需持有 mutex_ 或处于构造阶段
+    void openSegment()
+    {
+        auto segment = std::make_shared<Segment>();
+        segment->id = nextSegmentId_++;
+        segment->path = std::filesystem::path(dir_) / ("tier-" + std::to_string(segment->id) + ".seg");
+        segment->fd = ::open(segment->path.c_str(), O_CREAT | O_RDWR | O_TRUNC | O_CLOEXEC, 0644);
+        if (segment->fd < 0)
+            throw std::runtime_error("FileTier: cannot open " + segment->path.string());
+        segments_[segment->id] = segment;
+        active_ = segment;
+    }
+
+    void writerLoop()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true)
+        {
+            writerCv_.wait_for(lock, std::chrono::milliseconds(10), [this]() {
+                return stop_ || flushRequested_ || pending_.size() >= batchSize_;
+            });
+            if (stop_)
+                return;
+
+            if (!pending_.empty())
+            {
+                inflight_.swap(pending_);
+                lock.unlock();
+                bool written = writeBatch();
+                lock.lock();
+                for (auto& entry : inflight_)
+                {
+                    // 写失败时放回 pending_，期间已有更新值的 key 以新值为准
+                    if (!written && pending_.try_emplace(entry.first, std::move(entry.second)).second)
+                        continue;
+                    track(entry.first, -1);
+                }
+                inflight_.clear();
+                if (!written)
+                {
+                    ++writeErrors_;
+                    flushedCv_.notify_all();
+                    writerCv_.wait_for(lock, std::chrono::milliseconds(100), [this]() { return stop_; });
+                    continue;
+                }
+            }
+            if (pending_.empty())
+            {
+                flushRequested_ = false;
+                flushedCv_.notify_all();
+            }
+
+            lock.unlock();
+            compactOneSegment();
+            lock.lock();
+        }
+    }
+
+    // 写入 inflight_ 中的条目；inflight_ 只会被本线程替换，其他线程最多删除其中的 key
+    bool writeBatch()
+    {
+        std::vector<std::pair<Key, Value>> batch;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            batch.assign(inflight_.begin(), inflight_.end());
+        }
+        return appendRecords(batch, [this](const Key& key) { return inflight_.count(key) > 0; }, nullptr);
+    }
+
+    // 把记录追加到活跃段；stillWanted 在持锁状态下判断记录是否仍需要建立索引，
+    // expected 不为空时只替换仍指向旧位置的索引项（用于压缩）。写文件失败时返回 false
+    template<typename Filter>
+    bool appendRecords(const std::vector<std::pair<Key, Value>>& records, Filter stillWanted,
+                       const std::vector<Location>* expected)
+    {
+        std::string buffer;
+        std::vector<Location> locations;
+        std::shared_ptr<Segment> segment;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (active_->size >= segmentBytes_)
+                openSegment();
+            segment = active_;
+        }
+
+        uint64_t offset = segment->size;
+        for (const auto& [key, value] : records)
+        {
+            size_t start = buffer.size();
+            encodeRecord(key, value, buffer);
+            locations.push_back(Location{segment->id, static_cast<uint32_t>(buffer.size() - start),
+                                         offset + start});
+        }
+        if (buffer.empty())
+            return true;
+
+        size_t written = 0;
+        while (written < buffer.size())
+        {
+            ssize_t n = ::pwrite(segment->fd, buffer.data() + written, buffer.size() - written, offset + written);
+            if (n <= 0)
+                return false;
+            written += n;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        segment->size += buffer.size();
+        appended_ += records.size();
+        for (size_t i = 0; i < records.size(); ++i)
+        {
+            const Key& key = records[i].first;
+            if (!stillWanted(key))
+                continue;
+
+            auto it = index_.find(key);
+            if (expected)
+            {
+                const Location& old = (*expected)[i];
+                if (it == index_.end() || it->second.segment != old.segment || it->second.offset != old.offset)
+                    continue;
+            }
+            if (it != index_.end())
+                segments_[it->second.segment]->liveBytes -= it->second.length;
+            else
+                track(key, 1);
+            index_[key] = locations[i];
+            segment->liveBytes += locations[i].length;
+        }
+        return true;
+    }
+
+    void compactOneSegment()
+    {
+        std::shared_ptr<Segment> victim;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (const auto& [id, segment] : segments_)
+            {
+                if (segment == active_ || segment->size == 0)
+                    continue;
+                if (static_cast<double>(segment->liveBytes) < compactRatio_ * segment->size)
+                {
+                    victim = segment;
+                    break;
+                }
+            }
+        }
+        if (!victim)
+            return;
+
+        std::string data(victim->size, '\0');
+        if (::pread(victim->fd, data.data(), data.size(), 0) != static_cast<ssize_t>(data.size()))
+            return;
+
+        std::vector<std::pair<Key, Value>> live;
+        std::vector<Location> expected;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            uint64_t offset = 0;
+            std::string_view keyBytes;
+            std::string_view valueBytes;
+            while (offset < data.size()
+                   && parseRecord(std::string_view(data).substr(offset), keyBytes, valueBytes))
+            {
+                uint32_t length = static_cast<uint32_t>(sizeof(RecordHeader) + keyBytes.size() + valueBytes.size());
+                Key key{};
+                Value value{};
+                if (TierCodec<Key>::decode(keyBytes, key))
+                {
+                    auto it = index_.find(key);
+                    if (it != index_.end() && it->second.segment == victim->id && it->second.offset == offset
+                        && TierCodec<Value>::decode(valueBytes, value))
+                    {
+                        live.emplace_back(std::move(key), std::move(value));
+                        expected.push_back(it->second);
+                    }
+                }
+                offset += length;
+            }
+        }
+
+        bool written = appendRecords(live, [](const Key&) { return true; }, &expected);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!written)
+        {
+            ++writeErrors_;
+            return;
+        }
+        // 压缩期间又被写回的条目仍指向旧段时保留旧段，下一轮再处理
+        for (const auto& [key, location] : index_)
+        {
+            if (location.segment == victim->id)
+                return;
+        }
+        victim->removeOnClose = true;
+        segments_.erase(victim->id);
+        ++compactions_;
+    }
+
+private:
+    std::string                                     dir_;
+    uint64_t                                        segmentBytes_;
+    double                                          compactRatio_;
+    size_t                                          batchSize_;
+    uint32_t                                        nextSegmentId_;
+    bool                                            stop_;
+    bool                                            flushRequested_;
+    std::mutex                                      mutex_;
+    std::condition_variable                         writerCv_;
+    std::condition_variable                         flushedCv_;
+    std::unordered_map<Key, Value>                  pending_;
+    std::unordered_map<Key, Value>                  inflight_;
+    std::unordered_map<Key, Location>               index_;
+    std::map<uint32_t, std::shared_ptr<Segment>>    segments_;
+    std::shared_ptr<Segment>                        active_;
+    uint64_t                                        appended_ = 0;
+    std::atomic<uint64_t>                           hits_{0};
+    std::atomic<uint64_t>                           misses_{0};
+    uint64_t                                        compactions_ = 0;
+    uint64_t                                        writeErrors_ = 0;
+    std::unique_ptr<std::atomic<uint32_t>[]>        presence_{new std::atomic<uint32_t>[size_t(1) << kPresenceBits]()};
+    std::unique_ptr<std::atomic<uint64_t>[]>        versions_{new std::atomic<uint64_t>[size_t(1) << kPresenceBits]()};
+    std::thread                                     writer_;
+};
+
+// 淘汰时把条目交给文件层的 LRU 分片
+template<typename Key, typename Value>
+class TieredLruCache : public LruBase<Key, Value>
+{
+public:
+    TieredLruCache(int capacity, FileTier<Key, Value>* tier)
+        : LruBase<Key, Value>(capacity)
+        , tier_(tier)
+    {}
+
+protected:
+    void onEvict(const Key& key, const Value& value) override
+    {
+        tier_->append(key, value);
+    }
+
+private:
+    FileTier<Key, Value>* tier_;
+};
+
+// 内存 + 本地文件两级缓存：内存未命中时查文件层，命中后提升回内存
+template<typename Key, typename Value>
+class HashTieredCaches
+{
+public:
+    HashTieredCaches(size_t capacity, int sliceNum, const std::string& dir,
+                     uint64_t segmentBytes = 64 << 20, double compactRatio = 0.5)
+        : tier_(std::make_unique<FileTier<Key, Value>>(dir, segmentBytes, compactRatio))
+        , caches_(capacity, sliceNum, tier_.get())
+    {}
+
+    void put(Key key, Value value)
+    {
+        tier_->erase(key);
+        caches_.put(key, value);
+    }
+
+    // 文件层的查找（含 pread）在分片锁外完成，提升时在锁内确认：内存中已有值则以内存为准，
+    // 文件层槽版本号变化（期间有写回或删除）则重新查找，因此并发写入的新值不会被旧值覆盖
+    bool get(Key key, Value& value)
+    {
+        if (caches_.get(key, value))
+            return true;
+
+        while (true)
+        {
+            uint64_t version = 0;
+            if (!tier_->lookup(key, value, &version))
+                return false;
+
+            bool present = false;
+            bool promoted = false;
+            caches_.mutate(key, [&](const Value* current) {
+                if (current)
+                {
+                    value = *current;
+                    present = true;
+                    return Mutation<Value>::keep();
+                }
+                if (tier_->version(key) != version)
+                    return Mutation<Value>::keep();
+                promoted = true;
+                return Mutation<Value>::set(value);
+            });
+            if (present)
+                return true;
+            if (promoted)
+            {
+                tier_->eraseIfUnchanged(key, version);
+                return true;
+            }
+        }
+    }
+
+    Value get(Key key)
+    {
+        Value value{};
+        get(key, value);
+        return value;
+    }
+
+    void remove(Key key)
+    {
+        // 在分片锁内清理文件层，锁外查到旧值的 get 会因版本号变化而放弃提升
+        caches_.mutate(key, [&](const Value*) {
+            tier_->erase(key);
+            return Mutation<Value>::remove();
+        });
+    }
+
+    FileTier<Key, Value>& tier() { return *tier_; }
+
+private:
+    // tier_ 需要比各分片活得更久
+    std::unique_ptr<FileTier<Key, Value>>                  tier_;
+    HashCaches<Key, Value, TieredLruCache<Key, Value>>     caches_;
+};
+
+}
@@ -0,0 +1,226 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <type_traits>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "CacheOps.h"
+#include "CacheSer.h"
+
+namespace MyCache
+{
+
+// 临界区只有几十条指令，用自旋锁代替 std::mutex，对象也更小
+class SpinLock
+{
+public:
+    void lock()
+    {
+        while (flag_.test_and_set(std::memory_order_acquire))
+        {
+            while (flag_.test(std::memory_order_relaxed))
+                ;
+        }
+    }
+
+    void unlock() { flag_.clear(std::memory_order_release); }
+
+private:
+    std::atomic_flag flag_;
+};
+
+// 容量在编译期确定的小型 LRU（适合 N 不超过几十的每连接缓存）：key、value 与访问时间戳都放在对象内的定长数组里，
+// 不做任何堆分配。条目紧凑地存放在前 size_ 个位置，删除时用最后一个条目填洞；淘汰时线性找时间戳最小者。
+// 4 字节或 8 字节的整数、枚举、指针类型 key 在支持 SSE2 时用 SIMD 一次比较 16 字节，其余类型逐个比较。
+template<typename Key, typename Value, size_t N>
+class FixedLruCache : public CacheSer<Key, Value>, public CacheOps<FixedLruCache<Key, Value, N>, Key, Value>
+{
+    static_assert(N > 0, "FixedLruCache needs a positive capacity");
+
+public:
+    FixedLruCache() = default;
+
+    // 与其他策略的构造参数保持一致，实际容量由 N 决定
+    explicit FixedLruCache(size_t) {}
+
+    ~FixedLruCache() override = default;
+
+    void put(Key key, Value value) override
+    {
+        std::lock_guard<SpinLock> lock(lock_);
+        putInternal(key, value);
+    }
+
+    bool get(Key key, Value& value) override
+    {
+        std::lock_guard<SpinLock> lock(lock_);
+        int index = find(key);
+        if (index < 0)
+            return false;
+        stamps_[index] = ++clock_;
+        value = values_[index];
+        return true;
+    }
+
+    Value get(Key key) override
+    {
+        Value value{};
+        get(key, value);
+        return value;
+    }
+
+    void remove(Key key)
+    {
+        std::lock_guard<SpinLock> lock(lock_);
+        int index = find(key);
+        if (index >= 0)
+            removeAt(index);
+    }
+
+    // 原子读改写的底层原语，见 CacheOps.h
+    template<typename Fn>
+    void mutate(const Key& key, Fn fn)
+    {
+        std::lock_guard<SpinLock> lock(lock_);
+        int index = find(key);
+        Mutation<Value> mutation = fn(index >= 0 ? &values_[index] : nullptr);
+        switch (mutation.kind)
+        {
+        case Mutation<Value>::Kind::Keep:
+            if (index >= 0)
+                stamps_[index] = ++clock_;
+            break;
+        case Mutation<Value>::Kind::Set:
+            putInternal(key, mutation.value);
+            break;
+        case Mutation<Value>::Kind::Remove:
+            if (index >= 0)
+                removeAt(index);
+            break;
+        }
+    }
+
+    size_t size()
+    {
+        std::lock_guard<SpinLock> lock(lock_);
+        return size_;
+    }
+
+    static constexpr size_t capacity() { return N; }
+
+private:
+    static constexpr bool kSimdKey =
+        (std::is_integral_v<Key> || std::is_enum_v<Key> || std::is_pointer_v<Key>)
+        && (sizeof(Key) == 4 || sizeof(Key) == 8);
+    // SIMD 查找按 16 字节整块读取，数组长度向上补齐
+    static constexpr size_t kLanes = kSimdKey ? 16 / sizeof(Key) : 1;
+    static constexpr size_t kSlots = (N + kLanes - 1) / kLanes * kLanes;
+
+    void putInternal(const Key& key, const Value& value)
+    {
+        int index = find(key);
+        if (index < 0)
+        {
+            if (size_ < N)
+            {
+                index = static_cast<int>(size_++);
+            }
+            else
+            {
+                index = 0;
+                for (size_t i = 1; i < N; ++i)
+                {
+                    if (stamps_[i] < stamps_[index])
+                        index = static_cast<int>(i);
+                }
+            }
+            keys_[index] = key;
+        }
+        values_[index] = value;
+        stamps_[index] = ++clock_;
+    }
+
+    void removeAt(int index)
+    {
+        size_t last = --size_;
+        if (static_cast<size_t>(index) != last)
+        {
+            keys_[index] = keys_[last];
+            values_[index] = std::move(values_[last]);
+            stamps_[index] = stamps_[last];
+        }
+        values_[last] = Value{};
+    }
+
+    int find(const Key& key) const
+    {
+#if defined(__SSE2__)
+        if constexpr (kSimdKey)
+            return findSimd(key);
+#endif
+        for (size_t i = 0; i < size_; ++i)
+        {
+            if (keys_[i] == key)
+                return static_cast<int>(i);
+        }
+        return -1;
+    }
+
+#if defined(__SSE2__)
+    // 补齐位置和已删除位置可能残留旧 key，命中位置不小于 size_ 时视为未找到（有效条目总在前面）
+    int findSimd(const Key& key) const
+    {
+        if constexpr (sizeof(Key) == 4)
+        {
+            int32_t bits;
+            std::memcpy(&bits, &key, sizeof(bits));
+            __m128i needle = _mm_set1_epi32(bits);
+            for (size_t i = 0; i < size_; i += kLanes)
+            {
+                __m128i chunk = _mm_load_si128(reinterpret_cast<const __m128i*>(&keys_[i]));
+                int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(chunk, needle)));
+                if (mask)
+                    return matchAt(i + __builtin_ctz(mask));
+            }
+        }
+        else
+        {
+            int64_t bits;
+            std::memcpy(&bits, &key, sizeof(bits));
+            __m128i needle = _mm_set1_epi64x(bits);
+            for (size_t i = 0; i < size_; i += kLanes)
+            {
+                __m128i chunk = _mm_load_si128(reinterpret_cast<const __m128i*>(&keys_[i]));
+                // SSE2 没有 64 位比较：两半都相等才算相等
+                __m128i eq = _mm_cmpeq_epi32(chunk, needle);
+                eq = _mm_and_si128(eq, _mm_shuffle_epi32(eq, _MM_SHUFFLE(2, 3, 0, 1)));
+                int mask = _mm_movemask_pd(_mm_castsi128_pd(eq));
+                if (mask)
+                    return matchAt(i + __builtin_ctz(mask));
+            }
+        }
+        return -1;
+    }
+
+    int matchAt(size_t index) const
+    {
+        return index < size_ ? static_cast<int>(index) : -1;
+    }
+#endif
+
+private:
+    alignas(16) Key keys_[kSlots]{};
+    Value           values_[N]{};
+    uint64_t        stamps_[N]{};
+    uint64_t        clock_ = 0;
+    size_t          size_ = 0;
+    SpinLock        lock_;
+};
+
+}
@@ -0,0 +1,258 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "CacheOps.h"
+#include "CacheSer.h"
+
+namespace MyCache
+{
+
+// GreedyDual-Size-Frequency：优先级 = L + 频率 × 未命中代价 / 大小，淘汰优先级最低的条目，
+// 并把膨胀时钟 L 推进到被淘汰者的优先级，使长期不被访问的旧条目逐渐落后于新条目。
+// capacity 按条目 size 之和计；不带代价与大小的 put 按代价 1、大小 1 处理。
+// 优先级放在带位置索引的二叉最小堆里，命中与淘汰都是 O(log n)；优先级相同时先淘汰较早访问的条目。
+template<typename Key, typename Value>
+class GdsfCache : public CacheSer<Key, Value>, public CacheOps<GdsfCache<Key, Value>, Key, Value>
+{
+public:
+    explicit GdsfCache(size_t capacity)
+        : capacity_(capacity)
+    {}
+
+    ~GdsfCache() override = default;
+
+    void put(Key key, Value value) override
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = index_.find(key);
+        if (it != index_.end())
+        {
+            Entry& entry = entries_[it->second];
+            putInternal(key, value, entry.cost, entry.size);
+        }
+        else
+        {
+            putInternal(key, value, 1.0, 1);
+        }
+    }
+
+    // cost 为未命中时重新获取的代价（如毫秒），size 为占用的容量；大于总容量的条目不缓存
+    void put(Key key, Value value, double cost, size_t size)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        putInternal(key, value, cost, size);
+    }
+
+    bool get(Key key, Value& value) override
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = index_.find(key);
+        if (it == index_.end())
+            return false;
+        touch(it->second);
+        value = entries_[it->second].value;
+        return true;
+    }
+
+    Value get(Key key) override
+    {
+        Value value{};
+        get(key, value);
+        return value;
+    }
+
+    void remove(Key key)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = index_.find(key);
+        if (it != index_.end())
+            removeSlot(it->second);
+    }
+
+    // 原子读改写的底层原语，见 CacheOps.h；写入已有条目时沿用其代价与大小
+    template<typename Fn>
+    void mutate(const Key& key, Fn fn)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = index_.find(key);
+        bool present = it != index_.end();
+        Mutation<Value> mutation = fn(present ? &entries_[it->second].value : nullptr);
+        switch (mutation.kind)
+        {
+        case Mutation<Value>::Kind::Keep:
+            if (present)
+                touch(it->second);
+            break;
+        case Mutation<Value>::Kind::Set:
+            if (present)
+                putInternal(key, mutation.value, entries_[it->second].cost, entries_[it->second].size);
+            else
+                putInternal(key, mutation.value, 1.0, 1);
+            break;
+        case Mutation<Value>::Kind::Remove:
+            if (present)
+                removeSlot(it->second);
+            break;
+        }
+    }
+
+    size_t usage()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return usage_;
+    }
+
+private:
+    struct Entry
+    {
+        Key      key;
+        Value    value;
+        double   cost;
+        size_t   size;
+        uint64_t freq;
+        double   priority;
+        uint64_t stamp;
+        size_t   heapPos;
+    };
+
+    void putInternal(const Key& key, const Value& value, double cost, size_t size)
+    {
+        auto it = index_.find(key);
+        if (size > capacity_)
+        {
+            if (it != index_.end())
+                removeSlot(it->second);
+            return;
+        }
+
+        size_t slot;
+        if (it != index_.end())
+        {
+            slot = it->second;
+            Entry& entry = entries_[slot];
+            usage_ = usage_ - entry.size + size;
+            entry.value = value;
+            entry.cost = cost;
+            entry.size = size;
+            touch(slot);
+        }
+        else
+        {
+            if (!freeSlots_.empty())
+            {
+                slot = freeSlots_.back();
+                freeSlots_.pop_back();
+                entries_[slot] = Entry{key, value, cost, size, 0, 0, 0, 0};
+            }
+            else
+            {
+                slot = entries_.size();
+                entries_.push_back(Entry{key, value, cost, size, 0, 0, 0, 0});
+            }
+            index_[key] = slot;
+            usage_ += size;
+            entries_[slot].heapPos = heap_.size();
+            heap_.push_back(slot);
+            touch(slot);
+        }
+
+        // 新条目自身可能是优先级最低的，此时被淘汰的就是它
+        while (usage_ > capacity_)
+        {
+            size_t victim = heap_.front();
+            clock_ = entries_[victim].priority;
+            removeSlot(victim);
+        }
+    }
+
+    // 访问一次：频率加一并按当前时钟重算优先级
+    void touch(size_t slot)
+    {
+        Entry& entry = entries_[slot];
+        ++entry.freq;
+        entry.priority = clock_ + entry.freq * entry.cost / static_cast<double>(entry.size ? entry.size : 1);
+        entry.stamp = ++stamp_;
+        siftDown(siftUp(entry.heapPos));
+    }
+
+    void removeSlot(size_t slot)
+    {
+        Entry& entry = entries_[slot];
+        size_t pos = entry.heapPos;
+        size_t last = heap_.back();
+        heap_.pop_back();
+        if (last != slot)
+        {
+            heap_[pos] = last;
+            entries_[last].heapPos = pos;
+            siftDown(siftUp(pos));
+        }
+        usage_ -= entry.size;
+        index_.erase(entry.key);
+        entry.value = Value{};
+        freeSlots_.push_back(slot);
+    }
+
+    bool less(size_t a, size_t b) const
+    {
+        const Entry& x = entries_[a];
+        const Entry& y = entries_[b];
+        return x.priority < y.priority || (x.priority == y.priority && x.stamp < y.stamp);
+    }
+
+    size_t siftUp(size_t pos)
+    {
+        while (pos > 0)
+        {
+            size_t parent = (pos - 1) / 2;
+            if (!less(heap_[pos], heap_[parent]))
+                break;
+            swapHeap(pos, parent);
+            pos = parent;
+        }
+        return pos;
+    }
+
+    void siftDown(size_t pos)
+    {
+        while (true)
+        {
+            size_t smallest = pos;
+            size_t left = pos * 2 + 1;
+            size_t right = left + 1;
+            if (left < heap_.size() && less(heap_[left], heap_[smallest]))
+                smallest = left;
+            if (right < heap_.size() && less(heap_[right], heap_[smallest]))
+                smallest = right;
+            if (smallest == pos)
+                return;
+            swapHeap(pos, smallest);
+            pos = smallest;
+        }
+    }
+
+    void swapHeap(size_t a, size_t b)
+    {
+        std::swap(heap_[a], heap_[b]);
+        entries_[heap_[a]].heapPos = a;
+        entries_[heap_[b]].heapPos = b;
+    }
+
+private:
+    size_t                          capacity_;
+    size_t                          usage_ = 0;
+    double                          clock_ = 0;
+    uint64_t                        stamp_ = 0;
+    std::mutex                      mutex_;
+    std::unordered_map<Key, size_t> index_;
+    std::vector<Entry>              entries_;
+    std::vector<size_t>             freeSlots_;
+    std::vector<size_t>             heap_;
+};
+
+}
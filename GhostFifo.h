@@ -0,0 +1,145 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace MyCache
+{
+
+// 只记录 key 指纹的幽灵队列：环形数组保存插入顺序，开放寻址的平坦表做成员查询。
+// 被 erase 的条目只从表里删除，环中留下的旧位置在轮转到时自然失效。
+class GhostFifo
+{
+public:
+    explicit GhostFifo(size_t capacity)
+        : capacity_(capacity)
+        , ring_(capacity)
+        , head_(0)
+        , count_(0)
+        , live_(0)
+    {
+        size_t tableSize = 4;
+        while (tableSize < capacity * 2)
+            tableSize <<= 1;
+        table_.assign(tableSize, Slot{0, 0});
+        mask_ = tableSize - 1;
+    }
+
+    template<typename Key>
+    static uint64_t fingerprint(const Key& key)
+    {
+        uint64_t hash = std::hash<Key>{}(key);
+        hash ^= hash >> 33;
+        hash *= 0xff51afd7ed558ccdULL;
+        hash ^= hash >> 33;
+        hash *= 0xc4ceb9fe1a85ec53ULL;
+        hash ^= hash >> 33;
+        return hash ? hash : 1;
+    }
+
+    void insert(uint64_t fp)
+    {
+        if (capacity_ == 0)
+            return;
+
+        if (count_ == capacity_)
+        {
+            size_t index = find(ring_[head_]);
+            if (index != npos && table_[index].pos == head_)
+                eraseAt(index);
+            head_ = (head_ + 1) % capacity_;
+            --count_;
+        }
+
+        size_t pos = (head_ + count_) % capacity_;
+        ring_[pos] = fp;
+        ++count_;
+
+        size_t index = find(fp);
+        if (index != npos)
+        {
+            table_[index].pos = pos;
+            return;
+        }
+        index = fp & mask_;
+        while (table_[index].fp != 0)
+            index = (index + 1) & mask_;
+        table_[index] = Slot{fp, pos};
+        ++live_;
+    }
+
+    bool contains(uint64_t fp) const { return find(fp) != npos; }
+
+    bool erase(uint64_t fp)
+    {
+        size_t index = find(fp);
+        if (index == npos)
+            return false;
+        eraseAt(index);
+        return true;
+    }
+
+    size_t size() const { return live_; }
+    size_t capacity() const { return capacity_; }
+
+    // 环形数组与平坦表占用的字节数，与实际记录的条目数无关
+    size_t memoryBytes() const
+    {
+        return ring_.capacity() * sizeof(uint64_t) + table_.capacity() * sizeof(Slot);
+    }
+
+    void clear()
+    {
+        table_.assign(table_.size(), Slot{0, 0});
+        head_ = count_ = live_ = 0;
+    }
+
+private:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    struct Slot
+    {
+        uint64_t fp;
+        size_t   pos;
+    };
+
+    size_t find(uint64_t fp) const
+    {
+        for (size_t index = fp & mask_; table_[index].fp != 0; index = (index + 1) & mask_)
+        {
+            if (table_[index].fp == fp)
+                return index;
+        }
+        return npos;
+    }
+
+    // 线性探测的反向移位删除，不留墓碑
+    void eraseAt(size_t hole)
+    {
+        for (size_t next = (hole + 1) & mask_; table_[next].fp != 0; next = (next + 1) & mask_)
+        {
+            size_t home = table_[next].fp & mask_;
+            bool movable = (next > hole) ? (home <= hole || home > next)
+                                         : (home <= hole && home > next);
+            if (movable)
+            {
+                table_[hole] = table_[next];
+                hole = next;
+            }
+        }
+        table_[hole].fp = 0;
+        --live_;
+    }
+
+private:
+    size_t                capacity_;
+    std::vector<uint64_t> ring_;
+    size_t                head_;
+    size_t                count_;
+    size_t                live_;
+    std::vector<Slot>     table_;
+    size_t                mask_;
+};
+
+}
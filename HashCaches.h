@@ -0,0 +1,113 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "CacheOps.h"
+#include "MemoryUsage.h"
+
+namespace MyCache
+{
+
+// 通用分片包装：按 key 的哈希把请求分发到各自独立加锁的分片，
+// 构造时额外的参数原样转发给每个分片的构造函数
+template<typename Key, typename Value, typename CacheType>
+class HashCaches : public CacheOps<HashCaches<Key, Value, CacheType>, Key, Value>
+{
+public:
+    template<typename... Args>
+    HashCaches(size_t capacity, int sliceNum, Args... args)
+        : capacity_(capacity)
+        , sliceNum_(sliceNum > 0 ? sliceNum : std::max(1u, std::thread::hardware_concurrency()))
+    {
+        size_t sliceSize = std::ceil(capacity / static_cast<double>(sliceNum_));
+        for (int i = 0; i < sliceNum_; ++i)
+        {
+            sliceCaches_.emplace_back(new CacheType(sliceSize, args...));
+        }
+    }
+
+    // 额外参数（如代价、大小）原样转发给分片的 put
+    template<typename... Extra>
+    void put(Key key, Value value, Extra&&... extra)
+    {
+        return sliceCaches_[sliceIndex(key)]->put(key, value, std::forward<Extra>(extra)...);
+    }
+
+    bool get(Key key, Value& value)
+    {
+        return sliceCaches_[sliceIndex(key)]->get(key, value);
+    }
+
+    Value get(Key key)
+    {
+        Value value{};
+        get(key, value);
+        return value;
+    }
+
+    void remove(Key key)
+    {
+        sliceCaches_[sliceIndex(key)]->remove(key);
+    }
+
+    // 读改写在 key 所在分片内一次加锁完成，要求分片策略实现 mutate
+    template<typename Fn>
+    void mutate(const Key& key, Fn fn)
+    {
+        sliceCaches_[sliceIndex(key)]->mutate(key, fn);
+    }
+
+    // 每个分片各自缓冲、各自投递，回调可能在多个线程上并发执行
+    template<typename Listener>
+    void setEvictionListener(Listener listener)
+    {
+        for (auto& slice : sliceCaches_)
+        {
+            slice->setEvictionListener(listener);
+        }
+    }
+
+    void flushEvictions()
+    {
+        for (auto& slice : sliceCaches_)
+        {
+            slice->flushEvictions();
+        }
+    }
+
+    // 各分片的内存占用，要求分片策略实现 memoryUsage，见 MemoryUsage.h
+    std::vector<MemoryUsage> memoryUsage()
+    {
+        std::vector<MemoryUsage> shards;
+        for (auto& slice : sliceCaches_)
+        {
+            shards.push_back(slice->memoryUsage());
+        }
+        return shards;
+    }
+
+    int sliceNum() const { return sliceNum_; }
+
+    size_t sliceIndex(const Key& key) const { return Hash(key) % sliceNum_; }
+
+    CacheType& slice(size_t index) { return *sliceCaches_[index]; }
+
+private:
+    size_t Hash(const Key& key) const
+    {
+        std::hash<Key> hashFunc;
+        return hashFunc(key);
+    }
+
+private:
+    size_t                                  capacity_;
+    int                                     sliceNum_;
+    std::vector<std::unique_ptr<CacheType>> sliceCaches_;
+};
+
+}
@@ -1,20 +1,26 @@
 #pragma once
 
+#include <cmath>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "BulkLoad.h"
 #include "LfuBase.h"
 
-namespace MyHash {
+namespace MyCache {
 template<typename Key, typename Value>
-class HashLfu
+class HashLfu : public CacheOps<HashLfu<Key, Value>, Key, Value>
 {
 public:
     HashLfu(size_t capacity, int sliceNum, int maxAverageNum = 10)
-        : sliceNum_(sliceNum > 0 ? sliceNum : std::thread::hardware_concurrency())
-        , capacity_(capacity)
+        : capacity_(capacity)
+        , sliceNum_(sliceNum > 0 ? sliceNum : std::thread::hardware_concurrency())
     {
         size_t sliceSize = std::ceil(capacity_ / static_cast<double>(sliceNum_));
         for (int i = 0; i < sliceNum_; ++i)
         {
-            lfuSliceCaches_.emplace_back(new KLfuCache<Key, Value>(sliceSize, maxAverageNum));
+            lfuSliceCaches_.emplace_back(new LfuBase<Key, Value>(sliceSize, maxAverageNum));
         }
     }
 
@@ -37,6 +43,59 @@ public:
         return value;
     }
 
+    void remove(Key key)
+    {
+        size_t sliceIndex = Hash(key) % sliceNum_;
+        lfuSliceCaches_[sliceIndex]->remove(key);
+    }
+
+    // 读改写在 key 所在分片内一次加锁完成
+    template<typename Fn>
+    void mutate(const Key& key, Fn fn)
+    {
+        size_t sliceIndex = Hash(key) % sliceNum_;
+        lfuSliceCaches_[sliceIndex]->mutate(key, fn);
+    }
+
+    // 每个分片各自缓冲、各自投递，回调可能在多个线程上并发执行
+    void setEvictionListener(EvictionListener<Key, Value> listener)
+    {
+        for (auto& lfuSliceCache : lfuSliceCaches_)
+        {
+            lfuSliceCache->setEvictionListener(listener);
+        }
+    }
+
+    void flushEvictions()
+    {
+        for (auto& lfuSliceCache : lfuSliceCaches_)
+        {
+            lfuSliceCache->flushEvictions();
+        }
+    }
+
+    // 批量装载（用于预热），做法同 HashLruCaches::bulkLoad；装载的条目频率均为 1，同频率内按输入的新旧排列
+    template<typename Range>
+    void bulkLoad(const Range& entries, BulkOrder order = BulkOrder::LeastRecentFirst, int threads = 0)
+    {
+        auto parts = partitionForBulk(entries, sliceNum_, [this](const Key& key) { return Hash(key) % sliceNum_; },
+                                      order, threads);
+        std::vector<typename LfuBase<Key, Value>::BulkContents> bulks(sliceNum_);
+        parallelFor(sliceNum_, threads, [&](size_t i)
+        {
+            bulks[i] = lfuSliceCaches_[i]->prepareBulk(parts[i]);
+            std::vector<typename decltype(parts)::value_type::value_type>().swap(parts[i]);
+        });
+        for (int i = 0; i < sliceNum_; ++i)
+        {
+            lfuSliceCaches_[i]->publishBulk(bulks[i]);
+        }
+        parallelFor(sliceNum_, threads, [&](size_t i)
+        {
+            bulks[i] = typename LfuBase<Key, Value>::BulkContents();
+        });
+    }
+
     void purge()
     {
         for (auto& lfuSliceCache : lfuSliceCaches_)
@@ -45,6 +104,17 @@ public:
         }
     }
 
+    // 各分片的内存占用，见 MemoryUsage.h
+    std::vector<MemoryUsage> memoryUsage()
+    {
+        std::vector<MemoryUsage> shards;
+        for (auto& lfuSliceCache : lfuSliceCaches_)
+        {
+            shards.push_back(lfuSliceCache->memoryUsage());
+        }
+        return shards;
+    }
+
 private:
     size_t Hash(Key key)
     {
@@ -55,6 +125,6 @@ private:
 private:
     size_t capacity_; 
     int sliceNum_; 
-    std::vector<std::unique_ptr<KLfuCache<Key, Value>>> lfuSliceCaches_; 
+    std::vector<std::unique_ptr<LfuBase<Key, Value>>> lfuSliceCaches_; 
 };
 }
\ No newline at end of file
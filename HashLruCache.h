@@ -1,10 +1,17 @@
 #pragma once
+
+#include <cmath>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "BulkLoad.h"
 #include "LruBase.h"
 
 namespace MyCache {
 
 template<typename Key, typename Value>
-class HashLruCaches {
+class HashLruCaches : public CacheOps<HashLruCaches<Key, Value>, Key, Value> {
 public:
     HashLruCaches(size_t capacity, int sliceNum)
         : capacity_(capacity)
@@ -27,11 +34,71 @@ public:
     }
 
     Value get(Key key) {
-        Value value;
-        memset(&value, 0, sizeof Value);
+        Value value{};
         get(key, value);
         return value;
     }
+
+    void remove(Key key) {
+        size_t sliceIndex = Hash(key) % sliceNum_;
+        lruSliceCaches_[sliceIndex]->remove(key);
+    }
+
+    // 读改写在 key 所在分片内一次加锁完成
+    template<typename Fn>
+    void mutate(const Key& key, Fn fn) {
+        size_t sliceIndex = Hash(key) % sliceNum_;
+        lruSliceCaches_[sliceIndex]->mutate(key, fn);
+    }
+
+    // 每个分片各自缓冲、各自投递，回调可能在多个线程上并发执行
+    void setEvictionListener(EvictionListener<Key, Value> listener) {
+        for (auto& slice : lruSliceCaches_) {
+            slice->setEvictionListener(listener);
+        }
+    }
+
+    void flushEvictions() {
+        for (auto& slice : lruSliceCaches_) {
+            slice->flushEvictions();
+        }
+    }
+
+    // 批量装载（用于预热）：并行按分片划分输入，各分片在工作线程上直接构建索引与 LRU 链表，再逐个整体替换分片内容。
+    // entries 为随机访问区间，元素为 (key, value) 对；order 说明输入的新旧顺序，装载后的最近使用顺序与之一致
+    template<typename Range>
+    void bulkLoad(const Range& entries, BulkOrder order = BulkOrder::LeastRecentFirst, int threads = 0) {
+        auto parts = partitionForBulk(entries, sliceNum_, [this](const Key& key) { return Hash(key) % sliceNum_; },
+                                      order, threads);
+        std::vector<typename LruBase<Key, Value>::BulkContents> bulks(sliceNum_);
+        parallelFor(sliceNum_, threads, [&](size_t i) {
+            bulks[i] = lruSliceCaches_[i]->prepareBulk(parts[i]);
+            std::vector<typename decltype(parts)::value_type::value_type>().swap(parts[i]);
+        });
+        for (int i = 0; i < sliceNum_; i ++) {
+            lruSliceCaches_[i]->publishBulk(bulks[i]);
+        }
+        // 换下的旧内容同样并行释放
+        parallelFor(sliceNum_, threads, [&](size_t i) {
+            LruBase<Key, Value>::releaseBulk(bulks[i]);
+        });
+    }
+
+    // 各分片的内存占用，见 MemoryUsage.h
+    std::vector<MemoryUsage> memoryUsage() {
+        std::vector<MemoryUsage> shards;
+        for (auto& slice : lruSliceCaches_) {
+            shards.push_back(slice->memoryUsage());
+        }
+        return shards;
+    }
+
+    // 每个分片各自识别扫描
+    void setScanResistance(bool enabled) {
+        for (auto& slice : lruSliceCaches_) {
+            slice->setScanResistance(enabled);
+        }
+    }
 private:
     size_t Hash(Key key) {
         std::hash<Key> hashFunc;
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "HashCaches.h"
+#include "LruBase.h"
+#include "SlabAllocator.h"
+
+namespace MyCache
+{
+
+// 值存放在每个分片各自的 SlabAllocator 中，分片策略里只保存 SlabValue 句柄
+template<typename Key, typename CacheType = LruBase<Key, SlabValue>>
+class HashSlabCaches
+{
+public:
+    template<typename... Args>
+    HashSlabCaches(size_t capacity, int sliceNum, Args... args)
+        : caches_(capacity, sliceNum, args...)
+    {
+        for (int i = 0; i < caches_.sliceNum(); ++i)
+        {
+            stores_.emplace_back(new SlabAllocator());
+        }
+    }
+
+    void put(Key key, std::string_view value)
+    {
+        size_t sliceIndex = caches_.sliceIndex(key);
+        caches_.slice(sliceIndex).put(key, SlabValue(*stores_[sliceIndex], value));
+    }
+
+    bool get(Key key, std::string& value)
+    {
+        SlabValue slabValue;
+        if (!caches_.get(key, slabValue))
+            return false;
+        value.assign(slabValue.view());
+        return true;
+    }
+
+    std::string get(Key key)
+    {
+        std::string value;
+        get(key, value);
+        return value;
+    }
+
+    SlabAllocator::Stats memoryStats()
+    {
+        SlabAllocator::Stats total;
+        for (auto& store : stores_)
+        {
+            SlabAllocator::Stats stats = store->stats();
+            total.pages += stats.pages;
+            total.sparePages += stats.sparePages;
+            total.mappedBytes += stats.mappedBytes;
+            total.chunkBytes += stats.chunkBytes;
+            total.payloadBytes += stats.payloadBytes;
+            total.largeChunks += stats.largeChunks;
+        }
+        return total;
+    }
+
+private:
+    // stores_ 必须比 caches_ 活得更久：分片析构时还会释放句柄
+    std::vector<std::unique_ptr<SlabAllocator>> stores_;
+    HashCaches<Key, SlabValue, CacheType>       caches_;
+};
+
+}
@@ -0,0 +1,355 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "HashCaches.h"
+#include "LruBase.h"
+
+namespace MyCache
+{
+
+// 在线热点识别：对访问做 1/sampleRate 抽样，用 space-saving 算法维护 capacity 个计数器。
+// 计数器满时新 key 顶替计数最小者并继承其计数（error 记录高估量）；每 decayInterval 次抽样所有计数减半，
+// 使热点集合能跟随负载变化。未抽中的访问只增加一个线程局部计数；抽中的 key 先记入线程局部缓冲，
+// 攒够一批后用 try_lock 合并进计数器，拿不到锁就继续缓冲（缓冲满后丢弃新样本），读路径不会阻塞在跟踪器上。
+template<typename Key>
+class HotKeyTracker
+{
+public:
+    struct Counter
+    {
+        Key      key;
+        uint64_t count;
+        uint64_t error;
+    };
+
+    HotKeyTracker(size_t capacity = 64, uint32_t sampleRate = 8, double hotShare = 0.01,
+                  uint64_t decayInterval = 1 << 16)
+        : capacity_(std::max<size_t>(capacity, 1))
+        , sampleRate_(std::max<uint32_t>(sampleRate, 1))
+        , hotShare_(hotShare)
+        , decayInterval_(decayInterval)
+        , hot_(std::make_shared<const std::unordered_set<Key>>())
+        , id_(nextId().fetch_add(1, std::memory_order_relaxed))
+    {}
+
+    ~HotKeyTracker()
+    {
+        buffers().erase(id_);
+    }
+
+    HotKeyTracker(const HotKeyTracker&) = delete;
+    HotKeyTracker& operator=(const HotKeyTracker&) = delete;
+
+    void record(const Key& key)
+    {
+        thread_local uint32_t tick = 0;
+        if (++tick % sampleRate_ != 0)
+            return;
+
+        std::vector<Key>& buffer = localBuffer();
+        if (buffer.size() < kMaxBuffered)
+            buffer.push_back(key);
+        if (buffer.size() < kFoldBatch)
+            return;
+        std::unique_lock<std::mutex> lock(mutex_, std::try_to_lock);
+        if (lock.owns_lock())
+            fold(buffer);
+    }
+
+    // 按计数从高到低返回前 k 个（计数为抽样后的估计值）；只包含本线程缓冲的样本和已合并的样本
+    std::vector<Counter> topK(size_t k)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        fold(localBuffer());
+        std::vector<Counter> result(counters_);
+        std::sort(result.begin(), result.end(),
+                  [](const Counter& a, const Counter& b) { return a.count > b.count; });
+        if (result.size() > k)
+            result.resize(k);
+        return result;
+    }
+
+    // 当前热点集合的快照；generation 变化后调用方再重新获取
+    std::shared_ptr<const std::unordered_set<Key>> hotSet()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return hot_;
+    }
+
+    uint64_t generation() const { return generation_.load(std::memory_order_acquire); }
+
+private:
+    static constexpr uint64_t kRefreshInterval = 1024;
+    static constexpr size_t   kFoldBatch = 32;
+    static constexpr size_t   kMaxBuffered = 256;
+
+    static std::atomic<uint64_t>& nextId()
+    {
+        static std::atomic<uint64_t> id{0};
+        return id;
+    }
+
+    // 每个线程、每个跟踪器一份，以实例编号区分；其他线程中残留的缓冲在线程退出时释放
+    static std::unordered_map<uint64_t, std::vector<Key>>& buffers()
+    {
+        thread_local std::unordered_map<uint64_t, std::vector<Key>> buffers;
+        return buffers;
+    }
+
+    std::vector<Key>& localBuffer()
+    {
+        thread_local uint64_t cachedId = ~0ULL;
+        thread_local std::vector<Key>* cached = nullptr;
+        if (cachedId != id_)
+        {
+            cached = &buffers()[id_];
+            cachedId = id_;
+        }
+        return *cached;
+    }
+
+    // 需持有 mutex_
+    void fold(std::vector<Key>& buffer)
+    {
+        for (const Key& key : buffer)
+        {
+            add(key);
+        }
+        buffer.clear();
+    }
+
+    // 需持有 mutex_
+    void add(const Key& key)
+    {
+        ++samples_;
+        auto it = index_.find(key);
+        if (it != index_.end())
+        {
+            ++counters_[it->second].count;
+        }
+        else if (counters_.size() < capacity_)
+        {
+            index_[key] = counters_.size();
+            counters_.push_back(Counter{key, 1, 0});
+        }
+        else
+        {
+            size_t victim = 0;
+            for (size_t i = 1; i < counters_.size(); ++i)
+            {
+                if (counters_[i].count < counters_[victim].count)
+                    victim = i;
+            }
+            Counter& counter = counters_[victim];
+            index_.erase(counter.key);
+            index_[key] = victim;
+            counter = Counter{key, counter.count + 1, counter.count};
+        }
+
+        if (samples_ % kRefreshInterval == 0)
+            refreshHotSet();
+        if (decayInterval_ > 0 && samples_ % decayInterval_ == 0)
+            decay();
+    }
+
+    // 需持有 mutex_；计数减去高估量后仍超过窗口内抽样总数 hotShare 的 key 视为热点
+    void refreshHotSet()
+    {
+        uint64_t windowSamples = 0;
+        for (const auto& counter : counters_)
+        {
+            windowSamples += counter.count;
+        }
+        auto hot = std::make_shared<std::unordered_set<Key>>();
+        for (const auto& counter : counters_)
+        {
+            if (counter.count - counter.error >= hotShare_ * windowSamples)
+                hot->insert(counter.key);
+        }
+        if (*hot != *hot_)
+        {
+            hot_ = std::move(hot);
+            generation_.fetch_add(1, std::memory_order_release);
+        }
+    }
+
+    void decay()
+    {
+        for (auto& counter : counters_)
+        {
+            counter.count /= 2;
+            counter.error /= 2;
+        }
+    }
+
+private:
+    size_t                                         capacity_;
+    uint32_t                                       sampleRate_;
+    double                                         hotShare_;
+    uint64_t                                       decayInterval_;
+    std::mutex                                     mutex_;
+    uint64_t                                       samples_ = 0;
+    std::vector<Counter>                           counters_;
+    std::unordered_map<Key, size_t>                index_;
+    std::shared_ptr<const std::unordered_set<Key>> hot_;
+    std::atomic<uint64_t>                          generation_{0};
+    uint64_t                                       id_;
+};
+
+// 带热点近端缓存的分片缓存：热点 key 的值额外缓存在每个线程自己的 L1 中，命中时不访问共享分片。
+// 失效依靠分段版本号：put/remove 写完分片后递增 key 所在分段的版本，L1 条目记录填充前读到的版本，
+// 读取时版本不一致即视为失效。同一线程 put 之后的 get 一定能看到新值，其他线程在版本递增后也不会再读到旧值。
+template<typename Key, typename Value, typename CacheType = LruBase<Key, Value>>
+class HashHotKeyCaches
+{
+public:
+    using Counter = typename HotKeyTracker<Key>::Counter;
+
+    template<typename... Args>
+    HashHotKeyCaches(size_t capacity, int sliceNum, bool nearCache = true, size_t trackerCapacity = 64,
+                     size_t versionStripes = 1024, Args... args)
+        : caches_(capacity, sliceNum, args...)
+        , tracker_(trackerCapacity)
+        , nearCache_(nearCache)
+        , versions_(std::max<size_t>(versionStripes, 1))
+        , id_(nextId().fetch_add(1, std::memory_order_relaxed))
+    {}
+
+    ~HashHotKeyCaches()
+    {
+        nearCaches().erase(id_);
+    }
+
+    void put(Key key, Value value)
+    {
+        caches_.put(key, value);
+        bumpVersion(key);
+    }
+
+    bool get(Key key, Value& value)
+    {
+        tracker_.record(key);
+        if (!nearCache_)
+            return caches_.get(key, value);
+
+        NearCache& near = localNearCache();
+        bool hot = near.hot->count(key) > 0;
+        std::atomic<uint64_t>& version = versionOf(key);
+        if (hot)
+        {
+            auto it = near.entries.find(key);
+            if (it != near.entries.end())
+            {
+                if (it->second.version == version.load(std::memory_order_acquire))
+                {
+                    value = it->second.value;
+                    ++near.hits;
+                    return true;
+                }
+                near.entries.erase(it);
+            }
+        }
+
+        uint64_t observed = version.load(std::memory_order_acquire);
+        if (!caches_.get(key, value))
+            return false;
+        if (hot)
+            near.entries.insert_or_assign(key, NearEntry{value, observed});
+        return true;
+    }
+
+    Value get(Key key)
+    {
+        Value value{};
+        get(key, value);
+        return value;
+    }
+
+    void remove(Key key)
+    {
+        caches_.remove(key);
+        bumpVersion(key);
+    }
+
+    std::vector<Counter> topK(size_t k = 10) { return tracker_.topK(k); }
+
+    // 当前线程 L1 的命中次数，供观察近端缓存效果
+    uint64_t nearHits() { return localNearCache().hits; }
+
+private:
+    struct NearEntry
+    {
+        Value    value;
+        uint64_t version;
+    };
+
+    // 每个线程、每个缓存实例一份，只收录热点 key，规模不超过热点集合
+    struct NearCache
+    {
+        uint64_t                                       generation = ~0ULL;
+        std::shared_ptr<const std::unordered_set<Key>> hot;
+        std::unordered_map<Key, NearEntry>             entries;
+        uint64_t                                       hits = 0;
+    };
+
+    static std::atomic<uint64_t>& nextId()
+    {
+        static std::atomic<uint64_t> id{0};
+        return id;
+    }
+
+    // 以实例编号区分，避免实例析构后地址复用读到旧数据；其他线程中残留的条目在线程退出时释放
+    static std::unordered_map<uint64_t, NearCache>& nearCaches()
+    {
+        thread_local std::unordered_map<uint64_t, NearCache> caches;
+        return caches;
+    }
+
+    NearCache& localNearCache()
+    {
+        NearCache& near = nearCaches()[id_];
+        uint64_t generation = tracker_.generation();
+        if (near.generation != generation)
+        {
+            near.generation = generation;
+            near.hot = tracker_.hotSet();
+            for (auto it = near.entries.begin(); it != near.entries.end();)
+            {
+                if (near.hot->count(it->first))
+                    ++it;
+                else
+                    it = near.entries.erase(it);
+            }
+        }
+        return near;
+    }
+
+    std::atomic<uint64_t>& versionOf(const Key& key)
+    {
+        return versions_[std::hash<Key>()(key) % versions_.size()];
+    }
+
+    void bumpVersion(const Key& key)
+    {
+        versionOf(key).fetch_add(1, std::memory_order_acq_rel);
+    }
+
+private:
+    HashCaches<Key, Value, CacheType>  caches_;
+    HotKeyTracker<Key>                 tracker_;
+    bool                               nearCache_;
+    std::vector<std::atomic<uint64_t>> versions_;
+    uint64_t                           id_;
+};
+
+}
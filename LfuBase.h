@@ -1,6 +1,16 @@
 #pragma once
 
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "CacheOps.h"
 #include "CacheSer.h"
+#include "EvictionListener.h"
+#include "MemoryUsage.h"
 
 namespace MyCache {
 template<typename Key, typename Value> class LfuBase;
@@ -29,15 +39,27 @@ private:
     NodePtr tail_;
 
 public:
-    explicit FreqList(int n) 
+    explicit FreqList(int n, AllocationCounter* counter = nullptr) 
      : freq_(n) 
     {
-      head_ = std::make_shared<Node>();
-      tail_ = std::make_shared<Node>();
+      head_ = std::allocate_shared<Node>(CountingAllocator<Node>(counter));
+      tail_ = std::allocate_shared<Node>(CountingAllocator<Node>(counter));
       head_->next = tail_;
       tail_->pre = head_;
     }
 
+    // 相邻节点互相持有，逐个断开，避免引用环泄漏
+    ~FreqList()
+    {
+      NodePtr node = std::move(head_);
+      while (node)
+      {
+        NodePtr next = std::move(node->next);
+        node->pre.reset();
+        node = std::move(next);
+      }
+    }
+
     bool isEmpty() const
     {
       return head_->next == tail_;
@@ -73,35 +95,51 @@ public:
 };
 
 template <typename Key, typename Value>
-class LfuBase : public CacheSer<Key, Value>
+class LfuBase : public CacheSer<Key, Value>, public CacheOps<LfuBase<Key, Value>, Key, Value>
 {
 public:
     using Node = typename FreqList<Key, Value>::Node;
     using NodePtr = std::shared_ptr<Node>;
-    using NodeMap = std::unordered_map<Key, NodePtr>;
+    using NodeMap = std::unordered_map<Key, NodePtr, std::hash<Key>, std::equal_to<Key>,
+                                       CountingAllocator<std::pair<const Key, NodePtr>>>;
+    using FreqListMap = std::unordered_map<int, FreqList<Key, Value>*, std::hash<int>, std::equal_to<int>,
+                                           CountingAllocator<std::pair<const int, FreqList<Key, Value>*>>>;
 
     LfuBase(int capacity, int maxAverageNum = 10)
     : capacity_(capacity), minFreq_(INT8_MAX), maxAverageNum_(maxAverageNum),
-      curAverageNum_(0), curTotalNum_(0) 
+      curAverageNum_(0), curTotalNum_(0),
+      nodeMap_(CountingAllocator<std::pair<const Key, NodePtr>>(&indexBytes_)),
+      freqToFreqList_(CountingAllocator<std::pair<const int, FreqList<Key, Value>*>>(&listBytes_))
     {}
 
-    ~LfuBase() override = default;
+    ~LfuBase() override
+    {
+        for (auto& entry : freqToFreqList_)
+        {
+            deleteFreqList(entry.second);
+        }
+    }
 
     void put(Key key, Value value) override
     {
         if (capacity_ <= 0)
             return;
 
-        std::lock_guard<std::mutex> lock(mutex_);
-        auto it = nodeMap_.find(key);
-        if (it != nodeMap_.end())
         {
-            it->second->value = value;
-            getInternal(it->second, value);
-            return;
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = nodeMap_.find(key);
+            if (it != nodeMap_.end())
+            {
+                evictions_.record(key, it->second->value, EvictionCause::Replaced);
+                it->second->value = value;
+                getInternal(it->second, value);
+            }
+            else
+            {
+                putInternal(key, value);
+            }
         }
-
-        putInternal(key, value);
+        evictions_.deliver(mutex_);
     }
 
     bool get(Key key, Value& value) override
@@ -124,15 +162,186 @@ public:
       return value;
     }
 
+    void remove(Key key)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = nodeMap_.find(key);
+            if (it != nodeMap_.end())
+                removeInternal(it);
+        }
+        evictions_.deliver(mutex_);
+    }
+
+    // 原子读改写的底层原语，见 CacheOps.h
+    template<typename Fn>
+    void mutate(const Key& key, Fn fn)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = nodeMap_.find(key);
+            bool present = it != nodeMap_.end();
+            Mutation<Value> mutation = fn(present ? &it->second->value : nullptr);
+            switch (mutation.kind)
+            {
+            case Mutation<Value>::Kind::Keep:
+                if (present)
+                    touch(it->second);
+                break;
+            case Mutation<Value>::Kind::Set:
+                if (present)
+                {
+                    evictions_.record(key, it->second->value, EvictionCause::Replaced);
+                    it->second->value = mutation.value;
+                    touch(it->second);
+                }
+                else if (capacity_ > 0)
+                {
+                    putInternal(key, mutation.value);
+                }
+                break;
+            case Mutation<Value>::Kind::Remove:
+                if (present)
+                    removeInternal(it);
+                break;
+            }
+        }
+        evictions_.deliver(mutex_);
+    }
+
+    // 按淘汰顺序（频率从低到高，同频率先进先出）遍历 fn(key, value)，回调在锁内执行
+    template<typename Fn>
+    void forEach(Fn fn)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<int> freqs;
+        for (const auto& entry : freqToFreqList_)
+        {
+            freqs.push_back(entry.first);
+        }
+        std::sort(freqs.begin(), freqs.end());
+        for (int freq : freqs)
+        {
+            FreqList<Key, Value>* list = freqToFreqList_[freq];
+            for (NodePtr node = list->getFirstNode(); node != list->tail_; node = node->next)
+            {
+                fn(node->key, node->value);
+            }
+        }
+    }
+
+    // 批量装载分两步：prepareBulk 不加锁地构建好索引与频率链表（所有条目频率为 1，同频率内按新旧排列），
+    // publishBulk 在锁内整体替换现有内容，旧条目不产生淘汰通知
+    struct BulkContents
+    {
+        NodeMap     map;
+        FreqListMap lists;
+    };
+
+    // entries 为带 first / second 的元素指针，最近使用的在前；重复的 key 以更新的为准，超出容量的较旧条目直接丢弃
+    template<typename EntryPtr>
+    BulkContents prepareBulk(const std::vector<EntryPtr>& entries) const
+    {
+        BulkContents bulk;
+        bulk.map = NodeMap(CountingAllocator<std::pair<const Key, NodePtr>>(&indexBytes_));
+        bulk.lists = FreqListMap(CountingAllocator<std::pair<const int, FreqList<Key, Value>*>>(&listBytes_));
+        size_t capacity = std::max(capacity_, 0);
+        bulk.map.reserve(std::min(entries.size(), capacity));
+        std::vector<NodePtr> nodes;
+        nodes.reserve(std::min(entries.size(), capacity));
+        for (const auto& entry : entries)
+        {
+            if (bulk.map.size() >= capacity)
+                break;
+            auto [it, inserted] = bulk.map.try_emplace(entry->first);
+            if (!inserted)
+                continue;
+            it->second = makeNode(entry->first, entry->second);
+            nodes.push_back(it->second);
+        }
+
+        // 频率链表中越靠前越先被淘汰，由旧到新追加
+        auto* list = newFreqList(1);
+        for (auto it = nodes.rbegin(); it != nodes.rend(); ++it)
+        {
+            list->addNode(*it);
+        }
+        bulk.lists[1] = list;
+        return bulk;
+    }
+
+    void publishBulk(BulkContents& bulk)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            nodeMap_.swap(bulk.map);
+            freqToFreqList_.swap(bulk.lists);
+            curTotalNum_ = static_cast<int>(nodeMap_.size());
+            curAverageNum_ = nodeMap_.empty() ? 0 : 1;
+            minFreq_ = nodeMap_.empty() ? INT8_MAX : 1;
+        }
+        for (auto& entry : bulk.lists)
+        {
+            deleteFreqList(entry.second);
+        }
+        bulk.lists.clear();
+    }
+
+    // 按分配计数统计本分片的内存占用，频率链表计入元数据；key / value 可能持有堆内存时需遍历条目
+    MemoryUsage memoryUsage()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        MemoryUsage usage;
+        usage.entries = nodeMap_.size();
+        usage.indexBytes = indexBytes_.load(std::memory_order_relaxed);
+        usage.payloadBytes = usage.entries * (sizeof(Key) + sizeof(Value));
+        usage.metadataBytes = nodeBytes_.load(std::memory_order_relaxed) - usage.payloadBytes
+                            + listBytes_.load(std::memory_order_relaxed);
+        if constexpr (kMayOwnHeap<Key> || kMayOwnHeap<Value>)
+        {
+            for (const auto& entry : nodeMap_)
+            {
+                usage.indexBytes += heapBytes(entry.first);
+                usage.payloadBytes += heapBytes(entry.second->key) + heapBytes(entry.second->value);
+            }
+        }
+        return usage;
+    }
+
+    // 就地调整平均访问次数上限，已有条目的频率保留，超限时在下一次访问后照常减半
+    void setMaxAverageNum(int maxAverageNum)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        maxAverageNum_ = maxAverageNum;
+    }
+
+    // 淘汰、删除、覆盖的通知在锁内记入缓冲，释放锁后批量回调；传入空函数即取消
+    void setEvictionListener(EvictionListener<Key, Value> listener)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        evictions_.setListener(std::move(listener));
+    }
+
+    void flushEvictions()
+    {
+        evictions_.deliver(mutex_);
+    }
+
     void purge()
     {
       nodeMap_.clear();
+      for (auto& entry : freqToFreqList_)
+      {
+        deleteFreqList(entry.second);
+      }
       freqToFreqList_.clear();
     }
 
 private:
     void putInternal(Key key, Value value); 
     void getInternal(NodePtr node, Value& value); 
+    void touch(NodePtr node);
+    void removeInternal(typename NodeMap::iterator it);
 
     void kickOut(); 
 
@@ -144,6 +353,24 @@ private:
     void handleOverMaxAverageNum(); 
     void updateMinFreq();
 
+    // 节点与 shared_ptr 控制块一次分配，记入节点计数；频率链表对象及其哨兵节点记入链表计数
+    NodePtr makeNode(const Key& key, const Value& value) const
+    {
+        return std::allocate_shared<Node>(CountingAllocator<Node>(&nodeBytes_), key, value);
+    }
+
+    FreqList<Key, Value>* newFreqList(int freq) const
+    {
+        listBytes_.fetch_add(sizeof(FreqList<Key, Value>), std::memory_order_relaxed);
+        return new FreqList<Key, Value>(freq, &listBytes_);
+    }
+
+    void deleteFreqList(FreqList<Key, Value>* list) const
+    {
+        delete list;
+        listBytes_.fetch_sub(sizeof(FreqList<Key, Value>), std::memory_order_relaxed);
+    }
+
 private:
     int                                            capacity_; 
     int                                            minFreq_; 
@@ -151,14 +378,25 @@ private:
     int                                            curAverageNum_; 
     int                                            curTotalNum_; 
     std::mutex                                     mutex_; 
+    // 计数器须先于使用它们的容器构造、晚于其析构
+    mutable AllocationCounter                      indexBytes_{0};
+    mutable AllocationCounter                      nodeBytes_{0};
+    mutable AllocationCounter                      listBytes_{0};
     NodeMap                                        nodeMap_; 
-    std::unordered_map<int, FreqList<Key, Value>*> freqToFreqList_;
+    FreqListMap                                    freqToFreqList_;
+    EvictionBuffer<Key, Value>                     evictions_;
 };
 
 template<typename Key, typename Value>
 void LfuBase<Key, Value>::getInternal(NodePtr node, Value& value)
 {
     value = node->value;
+    touch(node);
+}
+
+template<typename Key, typename Value>
+void LfuBase<Key, Value>::touch(NodePtr node)
+{
     removeFromFreqList(node); 
     node->freq++;
     addToFreqList(node);
@@ -176,7 +414,7 @@ void LfuBase<Key, Value>::putInternal(Key key, Value value)
         kickOut();
     }
     
-    NodePtr node = std::make_shared<Node>(key, value);
+    NodePtr node = makeNode(key, value);
     nodeMap_[key] = node;
     addToFreqList(node);
     addFreqNum();
@@ -190,6 +428,19 @@ void LfuBase<Key, Value>::kickOut()
     removeFromFreqList(node);
     nodeMap_.erase(node->key);
     decreaseFreqNum(node->freq);
+    evictions_.record(node->key, node->value, EvictionCause::Capacity);
+}
+
+template<typename Key, typename Value>
+void LfuBase<Key, Value>::removeInternal(typename NodeMap::iterator it)
+{
+    NodePtr node = it->second;
+    removeFromFreqList(node);
+    nodeMap_.erase(it);
+    decreaseFreqNum(node->freq);
+    if (node->freq == minFreq_ && freqToFreqList_[minFreq_]->isEmpty())
+        updateMinFreq();
+    evictions_.record(node->key, node->value, EvictionCause::Explicit);
 }
 
 template<typename Key, typename Value>
@@ -211,7 +462,7 @@ void LfuBase<Key, Value>::addToFreqList(NodePtr node)
     auto freq = node->freq;
     if (freqToFreqList_.find(node->freq) == freqToFreqList_.end())
     {
-        freqToFreqList_[node->freq] = new FreqList<Key, Value>(node->freq);
+        freqToFreqList_[node->freq] = newFreqList(node->freq);
     }
 
     freqToFreqList_[freq]->addNode(node);
@@ -247,7 +498,7 @@ void LfuBase<Key, Value>::handleOverMaxAverageNum()
 {
     if (nodeMap_.empty())
         return;
-    minFreq_ = INI8_MAX;
+    minFreq_ = INT8_MAX;
     for (auto it = nodeMap_.begin(); it != nodeMap_.end(); ++it)
     {
         if (!it->second)
@@ -266,7 +517,7 @@ void LfuBase<Key, Value>::handleOverMaxAverageNum()
         addToFreqList(node);
     }
 
-    if (minFreq_ == INI8_MAX)
+    if (minFreq_ == INT8_MAX)
         minFreq_ = 1;
 }
 
@@ -0,0 +1,281 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+#include "CacheSer.h"
+#include "HashCaches.h"
+
+namespace MyCache
+{
+
+// LIRS：按重用距离（IRR）区分 LIR 与 HIR。
+// stack_ 记录近期访问过的 LIR/HIR（含已淘汰值的非驻留 HIR），栈底始终保持为 LIR；
+// queue_ 是驻留 HIR 的 FIFO，淘汰总是从这里取；nonResident_ 按变为非驻留的先后排队，
+// 用来把非驻留条目数量限制在 nonResidentCapacity_ 以内。
+template<typename Key, typename Value>
+class LirsCache : public CacheSer<Key, Value>
+{
+private:
+    enum class State { Lir, HirResident, HirNonResident };
+
+    using KeyList = std::list<Key>;
+    using KeyIter = typename KeyList::iterator;
+
+    struct Entry
+    {
+        Value   value;
+        State   state;
+        bool    inStack = false;
+        bool    inQueue = false;
+        KeyIter stackIt{};
+        KeyIter queueIt{};
+        KeyIter nonResidentIt{};
+    };
+
+    using EntryMap = std::unordered_map<Key, Entry>;
+
+public:
+    explicit LirsCache(int capacity, double hirRatio = 0.01, double nonResidentRatio = 1.0)
+        : capacity_(std::max(capacity, 0))
+        , hirCapacity_(capacity_ >= 2
+              ? std::clamp(static_cast<int>(std::lround(capacity_ * hirRatio)), 1, capacity_ - 1)
+              : 0)
+        , lirCapacity_(capacity_ - hirCapacity_)
+        , nonResidentCapacity_(static_cast<size_t>(std::max(1.0, capacity_ * nonResidentRatio)))
+        , lirCount_(0)
+        , residentCount_(0)
+    {}
+
+    ~LirsCache() override = default;
+
+    void put(Key key, Value value) override
+    {
+        if (capacity_ <= 0)
+            return;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(key);
+        if (it != entries_.end() && it->second.state != State::HirNonResident)
+        {
+            it->second.value = value;
+            access(it->first, it->second);
+            return;
+        }
+
+        if (residentCount_ >= capacity_)
+        {
+            evictResident();
+            it = entries_.find(key);
+        }
+        addResident(key, value, it);
+        boundNonResident();
+    }
+
+    bool get(Key key, Value& value) override
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(key);
+        if (it == entries_.end() || it->second.state == State::HirNonResident)
+            return false;
+
+        access(it->first, it->second);
+        value = it->second.value;
+        return true;
+    }
+
+    Value get(Key key) override
+    {
+        Value value{};
+        get(key, value);
+        return value;
+    }
+
+    void remove(Key key)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(key);
+        if (it == entries_.end())
+            return;
+
+        Entry& entry = it->second;
+        bool wasBottom = entry.inStack && entry.stackIt == stack_.begin();
+        if (entry.inStack)
+            stack_.erase(entry.stackIt);
+        if (entry.inQueue)
+            queue_.erase(entry.queueIt);
+        if (entry.state == State::HirNonResident)
+            nonResident_.erase(entry.nonResidentIt);
+        else
+            --residentCount_;
+        if (entry.state == State::Lir)
+            --lirCount_;
+        entries_.erase(it);
+
+        if (wasBottom)
+            pruneStack();
+    }
+
+private:
+    // 命中驻留条目后的状态迁移
+    void access(const Key& key, Entry& entry)
+    {
+        if (entry.state == State::Lir)
+        {
+            bool wasBottom = entry.stackIt == stack_.begin();
+            stack_.splice(stack_.end(), stack_, entry.stackIt);
+            if (wasBottom)
+                pruneStack();
+            return;
+        }
+
+        if (entry.inStack || lirCount_ < lirCapacity_)
+        {
+            // 驻留 HIR 仍在栈中，说明其重用距离小于栈底 LIR，晋升为 LIR
+            if (entry.inStack)
+                stack_.splice(stack_.end(), stack_, entry.stackIt);
+            else
+                entry.stackIt = stack_.insert(stack_.end(), key);
+            entry.inStack = true;
+            queue_.erase(entry.queueIt);
+            entry.inQueue = false;
+            entry.state = State::Lir;
+            ++lirCount_;
+            if (lirCount_ > lirCapacity_)
+                demoteBottomLir();
+        }
+        else
+        {
+            entry.stackIt = stack_.insert(stack_.end(), key);
+            entry.inStack = true;
+            queue_.splice(queue_.end(), queue_, entry.queueIt);
+        }
+    }
+
+    void addResident(const Key& key, const Value& value, typename EntryMap::iterator it)
+    {
+        if (it == entries_.end())
+        {
+            it = entries_.emplace(key, Entry{value, State::HirResident}).first;
+        }
+        else
+        {
+            // 非驻留 HIR 再次被访问，重用距离足够小
+            nonResident_.erase(it->second.nonResidentIt);
+            it->second.value = value;
+        }
+
+        Entry& entry = it->second;
+        ++residentCount_;
+        bool promote = entry.inStack || lirCount_ < lirCapacity_;
+        if (entry.inStack)
+            stack_.splice(stack_.end(), stack_, entry.stackIt);
+        else
+            entry.stackIt = stack_.insert(stack_.end(), it->first);
+        entry.inStack = true;
+
+        if (promote)
+        {
+            entry.state = State::Lir;
+            ++lirCount_;
+            if (lirCount_ > lirCapacity_)
+                demoteBottomLir();
+        }
+        else
+        {
+            entry.state = State::HirResident;
+            entry.queueIt = queue_.insert(queue_.end(), it->first);
+            entry.inQueue = true;
+        }
+    }
+
+    void evictResident()
+    {
+        if (queue_.empty())
+            demoteBottomLir();
+
+        auto it = entries_.find(queue_.front());
+        queue_.pop_front();
+        --residentCount_;
+
+        Entry& entry = it->second;
+        entry.inQueue = false;
+        if (entry.inStack)
+        {
+            entry.state = State::HirNonResident;
+            entry.value = Value{};
+            entry.nonResidentIt = nonResident_.insert(nonResident_.end(), it->first);
+        }
+        else
+        {
+            entries_.erase(it);
+        }
+    }
+
+    void demoteBottomLir()
+    {
+        auto it = entries_.find(stack_.front());
+        stack_.pop_front();
+        --lirCount_;
+
+        Entry& entry = it->second;
+        entry.inStack = false;
+        entry.state = State::HirResident;
+        entry.queueIt = queue_.insert(queue_.end(), it->first);
+        entry.inQueue = true;
+
+        pruneStack();
+    }
+
+    // 栈剪枝：弹出栈底的 HIR 条目，使栈底重新是 LIR
+    void pruneStack()
+    {
+        while (!stack_.empty())
+        {
+            auto it = entries_.find(stack_.front());
+            Entry& entry = it->second;
+            if (entry.state == State::Lir)
+                break;
+
+            stack_.pop_front();
+            entry.inStack = false;
+            if (entry.state == State::HirNonResident)
+            {
+                nonResident_.erase(entry.nonResidentIt);
+                entries_.erase(it);
+            }
+        }
+    }
+
+    void boundNonResident()
+    {
+        while (nonResident_.size() > nonResidentCapacity_)
+        {
+            auto it = entries_.find(nonResident_.front());
+            nonResident_.pop_front();
+            stack_.erase(it->second.stackIt);
+            entries_.erase(it);
+        }
+    }
+
+private:
+    int        capacity_;
+    int        hirCapacity_;
+    int        lirCapacity_;
+    size_t     nonResidentCapacity_;
+    int        lirCount_;
+    int        residentCount_;
+    std::mutex mutex_;
+    EntryMap   entries_;
+    KeyList    stack_;
+    KeyList    queue_;
+    KeyList    nonResident_;
+};
+
+template<typename Key, typename Value>
+using HashLirsCaches = HashCaches<Key, Value, LirsCache<Key, Value>>;
+
+}
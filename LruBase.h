@@ -1,9 +1,16 @@
 #pragma once
 
+#include <algorithm>
 #include <memory>
 #include <mutex>
 #include <unordered_map>
+#include <utility>
+#include <vector>
+#include "CacheOps.h"
 #include "CacheSer.h"
+#include "EvictionListener.h"
+#include "MemoryUsage.h"
+#include "ScanDetector.h"
 
 namespace MyCache 
 {
@@ -39,35 +46,41 @@ public:
 
 
 template<typename Key, typename Value>
-class LruBase : public CacheSer<Key, Value>
+class LruBase : public CacheSer<Key, Value>, public CacheOps<LruBase<Key, Value>, Key, Value>
 {
 public:
     using LruNodeType = LruNode<Key, Value>;
     using NodePtr = std::shared_ptr<LruNodeType>;
-    using NodeMap = std::unordered_map<Key, NodePtr>;
+    using NodeMap = std::unordered_map<Key, NodePtr, std::hash<Key>, std::equal_to<Key>,
+                                       CountingAllocator<std::pair<const Key, NodePtr>>>;
 
     LruBase(int capacity)
         : capacity_(capacity)
+        , usage_(0)
+        , nodeMap_(CountingAllocator<std::pair<const Key, NodePtr>>(&indexBytes_))
     {
         initializeList();
     }
 
-    ~LruBase() override = default;
+    ~LruBase() override
+    {
+        unlinkList(dummyHead_);
+    }
 
     void put(Key key, Value value) override
     {
         if (capacity_ <= 0)
             return;
     
-        std::lock_guard<std::mutex> lock(mutex_);
-        auto it = nodeMap_.find(key);
-        if (it != nodeMap_.end())
         {
-            updateExistingNode(it->second, value);
-            return ;
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = nodeMap_.find(key);
+            if (it != nodeMap_.end())
+                updateExistingNode(it->second, value);
+            else
+                addNewNode(key, value);
         }
-
-        addNewNode(key, value);
+        evictions_.deliver(mutex_);
     }
 
     bool get(Key key, Value& value) override
@@ -92,40 +105,223 @@ public:
 
     void remove(Key key) 
     {   
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = nodeMap_.find(key);
+            if (it != nodeMap_.end())
+                removeExistingNode(it);
+        }
+        evictions_.deliver(mutex_);
+    }
+
+    // 原子读改写的底层原语，见 CacheOps.h
+    template<typename Fn>
+    void mutate(const Key& key, Fn fn)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = nodeMap_.find(key);
+            bool present = it != nodeMap_.end();
+            Mutation<Value> mutation = fn(present ? &it->second->value_ : nullptr);
+            switch (mutation.kind)
+            {
+            case Mutation<Value>::Kind::Keep:
+                if (present)
+                    moveToMostRecent(it->second);
+                break;
+            case Mutation<Value>::Kind::Set:
+                if (present)
+                    updateExistingNode(it->second, mutation.value);
+                else if (capacity_ > 0)
+                    addNewNode(key, mutation.value);
+                break;
+            case Mutation<Value>::Kind::Remove:
+                if (present)
+                    removeExistingNode(it);
+                break;
+            }
+        }
+        evictions_.deliver(mutex_);
+    }
+
+    // 按淘汰顺序（最久未使用在前）遍历 fn(key, value)，回调在锁内执行，不能再访问同一个缓存
+    template<typename Fn>
+    void forEach(Fn fn)
+    {
         std::lock_guard<std::mutex> lock(mutex_);
-        auto it = nodeMap_.find(key);
-        if (it != nodeMap_.end())
+        for (NodePtr node = dummyHead_->next_; node != dummyTail_; node = node->next_)
         {
-            removeNode(it->second);
-            nodeMap_.erase(it);
+            fn(node->key_, node->value_);
         }
     }
 
+    // 批量装载分两步：prepareBulk 不加锁地构建好索引与链表，publishBulk 在锁内整体替换现有内容，
+    // 换下的旧内容留在 bulk 中由调用方在锁外释放，旧条目不产生淘汰通知
+    struct BulkContents
+    {
+        NodeMap map;
+        NodePtr head;
+        NodePtr tail;
+        size_t  usage = 0;
+    };
+
+    // entries 为带 first / second 的元素指针，最近使用的在前；重复的 key 以更新的为准，放不下的较旧条目直接丢弃
+    template<typename EntryPtr>
+    BulkContents prepareBulk(const std::vector<EntryPtr>& entries) const
+    {
+        BulkContents bulk;
+        bulk.map = NodeMap(CountingAllocator<std::pair<const Key, NodePtr>>(&indexBytes_));
+        bulk.head = makeNode(Key(), Value());
+        bulk.tail = makeNode(Key(), Value());
+        bulk.head->next_ = bulk.tail;
+        bulk.tail->prev_ = bulk.head;
+
+        size_t capacity = std::max(capacity_, 0);
+        bulk.map.reserve(std::min(entries.size(), capacity));
+        for (const auto& entry : entries)
+        {
+            size_t cost = charge(entry->second);
+            if (bulk.usage + cost > capacity)
+                break;
+            auto [it, inserted] = bulk.map.try_emplace(entry->first);
+            if (!inserted)
+                continue;
+            // 由新到旧，逐个放到最久未使用端
+            NodePtr node = makeNode(entry->first, entry->second);
+            node->prev_ = bulk.head;
+            node->next_ = bulk.head->next_;
+            bulk.head->next_->prev_ = node;
+            bulk.head->next_ = node;
+            it->second = std::move(node);
+            bulk.usage += cost;
+        }
+        return bulk;
+    }
+
+    void publishBulk(BulkContents& bulk)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        nodeMap_.swap(bulk.map);
+        dummyHead_.swap(bulk.head);
+        dummyTail_.swap(bulk.tail);
+        std::swap(usage_, bulk.usage);
+    }
+
+    // 释放 publishBulk 换下的旧内容，可在锁外调用
+    static void releaseBulk(BulkContents& bulk)
+    {
+        unlinkList(bulk.head);
+        bulk = BulkContents();
+    }
+
+    // 按分配计数统计本分片的内存占用；key / value 可能持有堆内存时需遍历条目
+    MemoryUsage memoryUsage()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        MemoryUsage usage;
+        usage.entries = nodeMap_.size();
+        usage.indexBytes = indexBytes_.load(std::memory_order_relaxed);
+        usage.payloadBytes = usage.entries * (sizeof(Key) + sizeof(Value));
+        usage.metadataBytes = nodeBytes_.load(std::memory_order_relaxed) - usage.payloadBytes;
+        if constexpr (kMayOwnHeap<Key> || kMayOwnHeap<Value>)
+        {
+            for (const auto& entry : nodeMap_)
+            {
+                usage.indexBytes += heapBytes(entry.first);
+                usage.payloadBytes += heapBytes(entry.second->key_) + heapBytes(entry.second->value_);
+            }
+        }
+        return usage;
+    }
+
+    // 淘汰、删除、覆盖的通知在锁内记入缓冲，释放锁后批量回调；传入空函数即取消
+    void setEvictionListener(EvictionListener<Key, Value> listener)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        evictions_.setListener(std::move(listener));
+    }
+
+    // 投递缓冲中尚未送出的通知（通常在每次修改后已自动投递）
+    void flushEvictions()
+    {
+        evictions_.deliver(mutex_);
+    }
+
+    // 开启后，识别为扫描的新 key 插入到最久未使用端，再次被访问才会提升，避免一次性扫描冲掉工作集
+    void setScanResistance(bool enabled)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        scanDetector_ = enabled ? std::make_unique<ScanDetector<Key>>(std::max(capacity_, 0)) : nullptr;
+    }
+
+protected:
+    // 条目占用的容量，默认每个条目记 1；子类可按字节数等计费
+    virtual size_t charge(const Value&) const { return 1; }
+
+    // 条目因容量不足被淘汰时调用（持有分片锁），子类可据此把条目转移到下一级存储
+    virtual void onEvict(const Key&, const Value&) {}
+
 private:
     void initializeList()
     {
-        dummyHead_ = std::make_shared<LruNodeType>(Key(), Value());
-        dummyTail_ = std::make_shared<LruNodeType>(Key(), Value());
+        dummyHead_ = makeNode(Key(), Value());
+        dummyTail_ = makeNode(Key(), Value());
         dummyHead_->next_ = dummyTail_;
         dummyTail_->prev_ = dummyHead_;
     }
 
     void updateExistingNode(NodePtr node, const Value& value) 
     {
+        usage_ = usage_ - charge(node->value_) + charge(value);
+        evictions_.record(node->key_, node->value_, EvictionCause::Replaced);
         node->setValue(value);
         moveToMostRecent(node);
+        while (usage_ > static_cast<size_t>(capacity_) && nodeMap_.size() > 1)
+        {
+            evictLeastRecent();
+        }
     }
 
     void addNewNode(const Key& key, const Value& value) 
     {
-       if (nodeMap_.size() >= capacity_) 
+       size_t cost = charge(value);
+       while (!nodeMap_.empty() && usage_ + cost > static_cast<size_t>(capacity_)) 
        {
            evictLeastRecent();
        }
 
-       NodePtr newNode = std::make_shared<LruNodeType>(key, value);
-       insertNode(newNode);
+       NodePtr newNode = makeNode(key, value);
+       if (scanDetector_ && scanDetector_->onInsert(key))
+           insertLeastRecent(newNode);
+       else
+           insertNode(newNode);
        nodeMap_[key] = newNode;
+       usage_ += cost;
+    }
+
+    // 节点与 shared_ptr 控制块一次分配，记入节点计数
+    NodePtr makeNode(const Key& key, const Value& value) const
+    {
+        return std::allocate_shared<LruNodeType>(CountingAllocator<LruNodeType>(&nodeBytes_), key, value);
+    }
+
+    // 相邻节点互相持有，析构前逐个断开链接，避免引用环泄漏，也避免长链表递归析构
+    static void unlinkList(NodePtr node)
+    {
+        while (node)
+        {
+            NodePtr next = std::move(node->next_);
+            node->prev_.reset();
+            node = std::move(next);
+        }
+    }
+
+    void removeExistingNode(typename NodeMap::iterator it)
+    {
+        usage_ -= charge(it->second->value_);
+        removeNode(it->second);
+        evictions_.record(it->first, it->second->value_, EvictionCause::Explicit);
+        nodeMap_.erase(it);
     }
 
     void moveToMostRecent(NodePtr node) 
@@ -148,18 +344,36 @@ private:
         dummyTail_->prev_ = node;
     }
 
+    void insertLeastRecent(NodePtr node)
+    {
+        node->prev_ = dummyHead_;
+        node->next_ = dummyHead_->next_;
+        dummyHead_->next_->prev_ = node;
+        dummyHead_->next_ = node;
+    }
+
     void evictLeastRecent() 
     {
         NodePtr leastRecent = dummyHead_->next_;
+        usage_ -= charge(leastRecent->value_);
         removeNode(leastRecent);
         nodeMap_.erase(leastRecent->getKey());
+        onEvict(leastRecent->key_, leastRecent->value_);
+        evictions_.record(leastRecent->key_, leastRecent->value_, EvictionCause::Capacity);
     }
 
 private:
     int          capacity_; 
+    size_t       usage_;
+    // 计数器须先于使用它们的容器构造、晚于其析构
+    mutable AllocationCounter indexBytes_{0};
+    mutable AllocationCounter nodeBytes_{0};
     NodeMap      nodeMap_; 
     std::mutex   mutex_;
     NodePtr      dummyHead_; 
     NodePtr      dummyTail_;
+
+    EvictionBuffer<Key, Value>         evictions_;
+    std::unique_ptr<ScanDetector<Key>> scanDetector_;
 };
 }
\ No newline at end of file
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+namespace MyCache
+{
+
+// 仓库内置的 LZ77 系列块压缩，格式与 LZ4 block 类似：
+// token 高 4 位为字面量长度、低 4 位为匹配长度 - 4，取 15 时后续字节继续累加；
+// 随后是字面量，再是 2 字节小端偏移。最后一个序列只有字面量。
+class LzCodec
+{
+public:
+    static void compress(std::string_view input, std::string& output)
+    {
+        output.clear();
+        output.reserve(input.size() + input.size() / 255 + 16);
+
+        const uint8_t* base = reinterpret_cast<const uint8_t*>(input.data());
+        const size_t size = input.size();
+        uint32_t table[kHashSize];
+        std::memset(table, 0xff, sizeof(table));
+
+        size_t anchor = 0;
+        size_t pos = 0;
+        while (size >= kMinMatch + kLastLiterals && pos + kMinMatch + kLastLiterals <= size)
+        {
+            uint32_t sequence = read32(base + pos);
+            uint32_t& slot = table[hash(sequence)];
+            size_t candidate = slot;
+            slot = static_cast<uint32_t>(pos);
+
+            if (candidate == kEmpty || pos - candidate > kMaxOffset || read32(base + candidate) != sequence)
+            {
+                ++pos;
+                continue;
+            }
+
+            size_t matchLength = kMinMatch;
+            size_t limit = size - kLastLiterals;
+            while (pos + matchLength < limit && base[candidate + matchLength] == base[pos + matchLength])
+                ++matchLength;
+
+            emitSequence(output, base + anchor, pos - anchor, matchLength, pos - candidate);
+            pos += matchLength;
+            anchor = pos;
+        }
+
+        emitLiterals(output, base + anchor, size - anchor);
+    }
+
+    // rawSize 为压缩前的长度，数据损坏时返回 false
+    static bool decompress(std::string_view input, size_t rawSize, std::string& output)
+    {
+        output.resize(rawSize);
+        const uint8_t* in = reinterpret_cast<const uint8_t*>(input.data());
+        const uint8_t* inEnd = in + input.size();
+        char* out = output.data();
+        size_t outPos = 0;
+
+        while (in < inEnd)
+        {
+            uint8_t token = *in++;
+            size_t literalLength = token >> 4;
+            if (literalLength == 15 && !readLength(in, inEnd, literalLength))
+                return false;
+            if (static_cast<size_t>(inEnd - in) < literalLength || rawSize - outPos < literalLength)
+                return false;
+            std::memcpy(out + outPos, in, literalLength);
+            in += literalLength;
+            outPos += literalLength;
+
+            if (in == inEnd)
+                break;
+
+            if (inEnd - in < 2)
+                return false;
+            size_t offset = in[0] | (static_cast<size_t>(in[1]) << 8);
+            in += 2;
+            size_t matchLength = (token & 0x0f);
+            if (matchLength == 15 && !readLength(in, inEnd, matchLength))
+                return false;
+            matchLength += kMinMatch;
+
+            if (offset == 0 || offset > outPos || rawSize - outPos < matchLength)
+                return false;
+            for (size_t i = 0; i < matchLength; ++i, ++outPos)
+                out[outPos] = out[outPos - offset];
+        }
+        return outPos == rawSize;
+    }
+
+private:
+    static constexpr size_t   kMinMatch = 4;
+    static constexpr size_t   kLastLiterals = 5;
+    static constexpr size_t   kMaxOffset = 65535;
+    static constexpr int      kHashBits = 12;
+    static constexpr size_t   kHashSize = 1 << kHashBits;
+    static constexpr uint32_t kEmpty = 0xffffffff;
+
+    static uint32_t read32(const uint8_t* p)
+    {
+        uint32_t value;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    static uint32_t hash(uint32_t sequence)
+    {
+        return (sequence * 2654435761U) >> (32 - kHashBits);
+    }
+
+    static void writeLength(std::string& output, size_t length)
+    {
+        while (length >= 255)
+        {
+            output.push_back(static_cast<char>(255));
+            length -= 255;
+        }
+        output.push_back(static_cast<char>(length));
+    }
+
+    static bool readLength(const uint8_t*& in, const uint8_t* inEnd, size_t& length)
+    {
+        uint8_t byte;
+        do
+        {
+            if (in == inEnd)
+                return false;
+            byte = *in++;
+            length += byte;
+        } while (byte == 255);
+        return true;
+    }
+
+    static void emitSequence(std::string& output, const uint8_t* literals, size_t literalLength,
+                             size_t matchLength, size_t offset)
+    {
+        size_t matchCode = matchLength - kMinMatch;
+        uint8_t token = static_cast<uint8_t>((std::min<size_t>(literalLength, 15) << 4) |
+                                             std::min<size_t>(matchCode, 15));
+        output.push_back(static_cast<char>(token));
+        if (literalLength >= 15)
+            writeLength(output, literalLength - 15);
+        output.append(reinterpret_cast<const char*>(literals), literalLength);
+        output.push_back(static_cast<char>(offset & 0xff));
+        output.push_back(static_cast<char>(offset >> 8));
+        if (matchCode >= 15)
+            writeLength(output, matchCode - 15);
+    }
+
+    static void emitLiterals(std::string& output, const uint8_t* literals, size_t literalLength)
+    {
+        output.push_back(static_cast<char>(std::min<size_t>(literalLength, 15) << 4));
+        if (literalLength >= 15)
+            writeLength(output, literalLength - 15);
+        output.append(reinterpret_cast<const char*>(literals), literalLength);
+    }
+};
+
+}
@@ -0,0 +1,585 @@
+#pragma once
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "HashLruCache.h"
+
+namespace MyCache
+{
+
+// 缓存中保存的 memcached 条目，值不可变，响应时直接引用其中的数据
+struct McItem
+{
+    uint32_t    flags;
+    uint64_t    cas;
+    std::string data;
+};
+
+using McItemPtr = std::shared_ptr<const McItem>;
+
+// memcached 文本协议服务：每个线程一个 epoll 循环和一个 SO_REUSEPORT 监听套接字，由内核分发连接，
+// 连接只在所属线程内处理。同一连接上流水线发来的多条命令一次读入后依次解析，
+// 响应以 iovec 列表的形式聚集发送，值部分直接指向缓存中的条目，不做拷贝。
+// 支持 get/gets（多 key）、set、delete、version、quit；exptime 会被解析但目前不生效。
+// 背压：待发送数据超过 kOutHighWater 时暂停解析并关闭 EPOLLIN，降到 kOutLowWater 以下再继续；
+// 输入缓冲最多容纳一条最大的 set 命令，满了之后暂停读取。连接关闭时先把已生成的响应发完。
+class McServer
+{
+public:
+    McServer(uint16_t port, size_t capacity, int threadNum = 0, size_t maxValueBytes = 1 << 20)
+        : port_(port)
+        , threadNum_(threadNum > 0 ? threadNum : std::max(1u, std::thread::hardware_concurrency()))
+        , maxValueBytes_(maxValueBytes)
+        , cache_(capacity, threadNum_)
+        , nextCas_(1)
+    {}
+
+    ~McServer()
+    {
+        stop();
+    }
+
+    McServer(const McServer&) = delete;
+    McServer& operator=(const McServer&) = delete;
+
+    // 创建各线程的监听套接字并启动事件循环；端口绑定失败时抛出异常
+    void start()
+    {
+        for (int i = 0; i < threadNum_; ++i)
+        {
+            auto loop = std::make_unique<EventLoop>();
+            loop->listenFd = openListener();
+            loop->epollFd = ::epoll_create1(EPOLL_CLOEXEC);
+            loop->wakeFd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+            addFd(loop->epollFd, loop->listenFd, EPOLLIN);
+            addFd(loop->epollFd, loop->wakeFd, EPOLLIN);
+            loops_.push_back(std::move(loop));
+        }
+        for (auto& loop : loops_)
+        {
+            EventLoop* raw = loop.get();
+            raw->thread = std::thread([this, raw]() { runLoop(*raw); });
+        }
+    }
+
+    void stop()
+    {
+        for (auto& loop : loops_)
+        {
+            uint64_t one = 1;
+            ssize_t ignored = ::write(loop->wakeFd, &one, sizeof(one));
+            (void)ignored;
+        }
+        for (auto& loop : loops_)
+        {
+            if (loop->thread.joinable())
+                loop->thread.join();
+            for (auto& [fd, conn] : loop->conns)
+            {
+                ::close(fd);
+            }
+            ::close(loop->listenFd);
+            ::close(loop->wakeFd);
+            ::close(loop->epollFd);
+        }
+        loops_.clear();
+    }
+
+    uint16_t port() const { return port_; }
+
+private:
+    // 输出队列中的一段：协议文本（owned）或缓存条目的值（item）
+    struct OutSegment
+    {
+        std::string owned;
+        McItemPtr   item;
+        const char* data;    // 仅 item 段使用
+        size_t      size;
+    };
+
+    struct Connection
+    {
+        int                    fd;
+        std::string            in;
+        size_t                 consumed = 0;
+        size_t                 swallow = 0;      // 过大的 set 数据需要丢弃的字节数
+        std::deque<OutSegment> out;
+        size_t                 outOffset = 0;    // out.front() 已发送的字节数
+        size_t                 outBytes = 0;     // out 中尚未发送的字节数
+        uint32_t               interest = static_cast<uint32_t>(EPOLLIN);
+        bool                   stalled = false;  // 输出积压而暂停解析，in 中可能还有完整命令
+        bool                   closing = false;  // 不再读取，发完已有响应后关闭
+        bool                   broken = false;   // 套接字出错，直接关闭
+    };
+
+    struct EventLoop
+    {
+        int                                                  listenFd = -1;
+        int                                                  epollFd = -1;
+        int                                                  wakeFd = -1;
+        std::thread                                          thread;
+        std::unordered_map<int, std::unique_ptr<Connection>> conns;
+    };
+
+    static constexpr size_t kReadChunk = 16 << 10;
+    static constexpr size_t kMaxLine = 2048;
+    static constexpr int    kMaxIov = 256;
+    static constexpr size_t kOutHighWater = 4 << 20;
+    static constexpr size_t kOutLowWater = 1 << 20;
+
+    int openListener()
+    {
+        int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        int one = 1;
+        ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        ::setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one));
+
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_ANY);
+        addr.sin_port = htons(port_);
+        if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || ::listen(fd, 1024) < 0)
+        {
+            ::close(fd);
+            throw std::runtime_error("McServer: cannot listen on port " + std::to_string(port_));
+        }
+        // 端口传 0 时记下内核分配的端口，后续线程绑定同一端口
+        socklen_t len = sizeof(addr);
+        ::getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len);
+        port_ = ntohs(addr.sin_port);
+        return fd;
+    }
+
+    static void addFd(int epollFd, int fd, uint32_t events)
+    {
+        epoll_event event{};
+        event.events = events;
+        event.data.fd = fd;
+        ::epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event);
+    }
+
+    void runLoop(EventLoop& loop)
+    {
+        std::vector<epoll_event> events(256);
+        while (true)
+        {
+            int n = ::epoll_wait(loop.epollFd, events.data(), static_cast<int>(events.size()), -1);
+            if (n < 0 && errno != EINTR)
+                return;
+            for (int i = 0; i < n; ++i)
+            {
+                int fd = events[i].data.fd;
+                if (fd == loop.wakeFd)
+                    return;
+                if (fd == loop.listenFd)
+                {
+                    acceptAll(loop);
+                    continue;
+                }
+
+                auto it = loop.conns.find(fd);
+                if (it == loop.conns.end())
+                    continue;
+                Connection& conn = *it->second;
+                if (events[i].events & (EPOLLERR | EPOLLHUP))
+                    conn.broken = true;
+                if (!conn.closing && !conn.broken && (events[i].events & EPOLLIN))
+                    onReadable(conn);
+                if (!conn.broken)
+                    flushOutput(conn);
+                // 输出排空后继续处理因积压而暂停的命令
+                while (conn.stalled && !conn.closing && !conn.broken && conn.outBytes < kOutLowWater)
+                {
+                    processBuffered(conn);
+                    flushOutput(conn);
+                }
+                // 即将关闭的连接等已生成的响应发完再关
+                if (conn.broken || (conn.closing && conn.out.empty()))
+                {
+                    ::close(fd);
+                    loop.conns.erase(it);
+                    continue;
+                }
+                updateInterest(loop, conn);
+            }
+        }
+    }
+
+    void acceptAll(EventLoop& loop)
+    {
+        while (true)
+        {
+            int fd = ::accept4(loop.listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0)
+                return;
+            int one = 1;
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            auto conn = std::make_unique<Connection>();
+            conn->fd = fd;
+            loop.conns[fd] = std::move(conn);
+            addFd(loop.epollFd, fd, EPOLLIN);
+        }
+    }
+
+    void updateInterest(EventLoop& loop, Connection& conn)
+    {
+        bool wantRead = !conn.closing && !conn.stalled && conn.outBytes < kOutHighWater
+                     && conn.in.size() < inputLimit();
+        uint32_t interest = (wantRead ? static_cast<uint32_t>(EPOLLIN) : 0u)
+                          | (conn.out.empty() ? 0u : static_cast<uint32_t>(EPOLLOUT));
+        if (interest == conn.interest)
+            return;
+        conn.interest = interest;
+        epoll_event event{};
+        event.events = interest;
+        event.data.fd = conn.fd;
+        ::epoll_ctl(loop.epollFd, EPOLL_CTL_MOD, conn.fd, &event);
+    }
+
+    // 一条最大的 set 命令（命令行 + 数据 + 结尾）加一次读取的余量
+    size_t inputLimit() const
+    {
+        return kMaxLine + maxValueBytes_ + kReadChunk;
+    }
+
+    void onReadable(Connection& conn)
+    {
+        bool peerClosed = false;
+        size_t limit = inputLimit();
+        while (conn.in.size() < limit)
+        {
+            size_t size = conn.in.size();
+            size_t chunk = std::min(kReadChunk, limit - size);
+            conn.in.resize(size + chunk);
+            ssize_t n = ::read(conn.fd, conn.in.data() + size, chunk);
+            conn.in.resize(size + (n > 0 ? n : 0));
+            if (n == 0 || (n < 0 && errno != EAGAIN && errno != EINTR))
+            {
+                peerClosed = true;
+                break;
+            }
+            if (n < 0 || static_cast<size_t>(n) < chunk)
+                break;
+        }
+
+        // 对端半关闭前发来的命令仍然处理并回复
+        processBuffered(conn);
+        if (peerClosed)
+            conn.closing = true;
+    }
+
+    void processBuffered(Connection& conn)
+    {
+        processInput(conn);
+        if (conn.consumed > 0)
+        {
+            conn.in.erase(0, conn.consumed);
+            conn.consumed = 0;
+        }
+    }
+
+    // 依次解析缓冲中所有完整的命令；待发送数据超过高水位时停下，等输出排空后继续
+    void processInput(Connection& conn)
+    {
+        conn.stalled = false;
+        while (!conn.closing)
+        {
+            if (conn.outBytes >= kOutHighWater)
+            {
+                conn.stalled = true;
+                return;
+            }
+            std::string_view pending(conn.in.data() + conn.consumed, conn.in.size() - conn.consumed);
+            if (conn.swallow > 0)
+            {
+                size_t n = std::min(conn.swallow, pending.size());
+                conn.swallow -= n;
+                conn.consumed += n;
+                if (conn.swallow > 0)
+                    return;
+                continue;
+            }
+
+            size_t eol = pending.find("\r\n");
+            if (eol == std::string_view::npos)
+            {
+                if (pending.size() > kMaxLine)
+                {
+                    appendText(conn, "CLIENT_ERROR line too long\r\n");
+                    conn.closing = true;
+                }
+                return;
+            }
+
+            std::string_view line = pending.substr(0, eol);
+            size_t lineBytes = eol + 2;
+            Tokens tokens = tokenize(line);
+            if (tokens.count == 0)
+            {
+                appendText(conn, "ERROR\r\n");
+                conn.consumed += lineBytes;
+                continue;
+            }
+
+            std::string_view command = tokens.items[0];
+            if (command == "set")
+            {
+                // 数据块尚未收全时等待下次可读
+                if (!handleSet(conn, tokens, pending, lineBytes))
+                    return;
+                continue;
+            }
+
+            conn.consumed += lineBytes;
+            if (command == "get" || command == "gets")
+                handleGet(conn, line.substr(command.data() + command.size() - line.data()), command == "gets");
+            else if (command == "delete")
+                handleDelete(conn, tokens);
+            else if (command == "version")
+                appendText(conn, "VERSION 1.6.0-mycache\r\n");
+            else if (command == "quit")
+                conn.closing = true;
+            else
+                appendText(conn, "ERROR\r\n");
+        }
+    }
+
+    struct Tokens
+    {
+        std::string_view items[8];
+        size_t           count = 0;
+    };
+
+    static Tokens tokenize(std::string_view line)
+    {
+        Tokens tokens;
+        size_t pos = 0;
+        while (pos < line.size())
+        {
+            while (pos < line.size() && line[pos] == ' ')
+                ++pos;
+            if (pos == line.size())
+                break;
+            size_t end = line.find(' ', pos);
+            if (end == std::string_view::npos)
+                end = line.size();
+            if (tokens.count == std::size(tokens.items))
+                break;
+            tokens.items[tokens.count++] = line.substr(pos, end - pos);
+            pos = end;
+        }
+        return tokens;
+    }
+
+    template<typename T>
+    static bool parseNumber(std::string_view text, T& value)
+    {
+        auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+        return result.ec == std::errc() && result.ptr == text.data() + text.size();
+    }
+
+    // set <key> <flags> <exptime> <bytes> [noreply]\r\n<data>\r\n
+    bool handleSet(Connection& conn, const Tokens& tokens, std::string_view pending, size_t lineBytes)
+    {
+        uint32_t flags;
+        int64_t exptime;
+        size_t bytes;
+        if ((tokens.count != 5 && tokens.count != 6) || tokens.items[1].size() > 250
+            || !parseNumber(tokens.items[2], flags) || !parseNumber(tokens.items[3], exptime)
+            || !parseNumber(tokens.items[4], bytes))
+        {
+            appendText(conn, "CLIENT_ERROR bad command line format\r\n");
+            conn.consumed += lineBytes;
+            return true;
+        }
+        bool noreply = tokens.count == 6 && tokens.items[5] == "noreply";
+
+        if (bytes > maxValueBytes_)
+        {
+            appendText(conn, "SERVER_ERROR object too large for cache\r\n");
+            conn.consumed += lineBytes;
+            conn.swallow = bytes + 2;
+            return true;
+        }
+        if (pending.size() < lineBytes + bytes + 2)
+            return false;
+
+        std::string_view data = pending.substr(lineBytes, bytes);
+        if (pending.substr(lineBytes + bytes, 2) != "\r\n")
+        {
+            appendText(conn, "CLIENT_ERROR bad data chunk\r\n");
+            conn.consumed += lineBytes + bytes + 2;
+            return true;
+        }
+
+        auto item = std::make_shared<const McItem>(McItem{flags, nextCas_.fetch_add(1, std::memory_order_relaxed),
+                                                          std::string(data)});
+        cache_.put(std::string(tokens.items[1]), std::move(item));
+        conn.consumed += lineBytes + bytes + 2;
+        if (!noreply)
+            appendText(conn, "STORED\r\n");
+        return true;
+    }
+
+    // get/gets <key>*，keys 为命令名之后的部分，key 数量不限
+    void handleGet(Connection& conn, std::string_view keys, bool withCas)
+    {
+        std::string key;
+        McItemPtr item;
+        size_t pos = 0;
+        bool anyKey = false;
+        while (pos < keys.size())
+        {
+            while (pos < keys.size() && keys[pos] == ' ')
+                ++pos;
+            if (pos == keys.size())
+                break;
+            size_t end = std::min(keys.find(' ', pos), keys.size());
+            key.assign(keys.substr(pos, end - pos));
+            pos = end;
+            anyKey = true;
+            if (!cache_.get(key, item) || !item)
+                continue;
+
+            std::string header;
+            header.reserve(key.size() + 48);
+            header.append("VALUE ").append(key).append(" ").append(std::to_string(item->flags))
+                  .append(" ").append(std::to_string(item->data.size()));
+            if (withCas)
+                header.append(" ").append(std::to_string(item->cas));
+            header.append("\r\n");
+            appendText(conn, header);
+            appendItem(conn, item);
+            appendText(conn, "\r\n");
+        }
+        appendText(conn, anyKey ? "END\r\n" : "ERROR\r\n");
+    }
+
+    // delete <key> [noreply]
+    void handleDelete(Connection& conn, const Tokens& tokens)
+    {
+        if (tokens.count != 2 && tokens.count != 3)
+        {
+            appendText(conn, "CLIENT_ERROR bad command line format\r\n");
+            return;
+        }
+        bool noreply = tokens.count == 3 && tokens.items[2] == "noreply";
+        std::string key(tokens.items[1]);
+        // 判断存在与删除在同一次分片加锁内完成
+        bool found = false;
+        cache_.mutate(key, [&](const McItemPtr* current) {
+            if (!current)
+                return Mutation<McItemPtr>::keep();
+            found = static_cast<bool>(*current);
+            return Mutation<McItemPtr>::remove();
+        });
+        if (!noreply)
+            appendText(conn, found ? "DELETED\r\n" : "NOT_FOUND\r\n");
+    }
+
+    // 相邻的协议文本合并到同一段，减少 iovec 数量
+    static void appendText(Connection& conn, std::string_view text)
+    {
+        if (conn.out.empty() || conn.out.back().item || conn.out.back().owned.size() >= 4096)
+            conn.out.push_back(OutSegment{{}, nullptr, nullptr, 0});
+        conn.out.back().owned.append(text);
+        conn.outBytes += text.size();
+    }
+
+    static void appendItem(Connection& conn, const McItemPtr& item)
+    {
+        conn.out.push_back(OutSegment{{}, item, item->data.data(), item->data.size()});
+        conn.outBytes += item->data.size();
+    }
+
+    static std::string_view segmentView(const OutSegment& segment)
+    {
+        if (segment.data)
+            return std::string_view(segment.data, segment.size);
+        return segment.owned;
+    }
+
+    // 用 sendmsg 的 iovec 聚集发送输出队列（MSG_NOSIGNAL 避免对端关闭时触发 SIGPIPE），
+    // 写满内核缓冲时留待 EPOLLOUT
+    static void flushOutput(Connection& conn)
+    {
+        iovec iov[kMaxIov];
+        while (!conn.out.empty())
+        {
+            int count = 0;
+            for (auto it = conn.out.begin(); it != conn.out.end() && count < kMaxIov; ++it, ++count)
+            {
+                std::string_view view = segmentView(*it);
+                if (count == 0)
+                    view.remove_prefix(conn.outOffset);
+                iov[count].iov_base = const_cast<char*>(view.data());
+                iov[count].iov_len = view.size();
+            }
+
+            msghdr message{};
+            message.msg_iov = iov;
+            message.msg_iovlen = count;
+            ssize_t n = ::sendmsg(conn.fd, &message, MSG_NOSIGNAL);
+            if (n < 0)
+            {
+                if (errno != EAGAIN && errno != EINTR)
+                    conn.broken = true;
+                return;
+            }
+
+            size_t written = static_cast<size_t>(n);
+            conn.outBytes -= written;
+            while (written > 0 && !conn.out.empty())
+            {
+                size_t remaining = segmentView(conn.out.front()).size() - conn.outOffset;
+                if (written < remaining)
+                {
+                    conn.outOffset += written;
+                    break;
+                }
+                written -= remaining;
+                conn.out.pop_front();
+                conn.outOffset = 0;
+            }
+            // 空段（如空值）直接弹出
+            while (!conn.out.empty() && segmentView(conn.out.front()).size() == conn.outOffset)
+            {
+                conn.out.pop_front();
+                conn.outOffset = 0;
+            }
+        }
+    }
+
+private:
+    uint16_t                                port_;
+    int                                     threadNum_;
+    size_t                                  maxValueBytes_;
+    HashLruCaches<std::string, McItemPtr>   cache_;
+    std::atomic<uint64_t>                   nextCas_;
+    std::vector<std::unique_ptr<EventLoop>> loops_;
+};
+
+}
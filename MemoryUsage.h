@@ -0,0 +1,114 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace MyCache
+{
+
+// 一个分片的内存占用（字节）：
+// index    —— key 到条目的哈希索引（桶数组与索引节点，含索引里保存的 key 副本）
+// metadata —— 条目节点本身除 key / value 以外的部分（shared_ptr 控制块、链表指针、计数等）、频率链表、幽灵表
+// payload  —— 条目节点内的 key / value 对象及它们自己在堆上持有的内存
+struct MemoryUsage
+{
+    size_t entries = 0;
+    size_t indexBytes = 0;
+    size_t metadataBytes = 0;
+    size_t payloadBytes = 0;
+
+    size_t totalBytes() const { return indexBytes + metadataBytes + payloadBytes; }
+
+    MemoryUsage& operator+=(const MemoryUsage& other)
+    {
+        entries += other.entries;
+        indexBytes += other.indexBytes;
+        metadataBytes += other.metadataBytes;
+        payloadBytes += other.payloadBytes;
+        return *this;
+    }
+};
+
+inline MemoryUsage totalOf(const std::vector<MemoryUsage>& shards)
+{
+    MemoryUsage total;
+    for (const MemoryUsage& shard : shards)
+        total += shard;
+    return total;
+}
+
+// 分配计数：分片的容器与节点经 CountingAllocator 分配，按用途记到不同的计数器上。
+// 批量装载会在锁外分配，所以用原子量
+using AllocationCounter = std::atomic<size_t>;
+
+// 有状态的计数分配器，counter 为空时只转发不计数；拷贝、移动、交换容器时随之传播，保证释放记回同一个计数器
+template<typename T>
+class CountingAllocator
+{
+public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    CountingAllocator() noexcept = default;
+    explicit CountingAllocator(AllocationCounter* counter) noexcept : counter_(counter) {}
+
+    template<typename U>
+    CountingAllocator(const CountingAllocator<U>& other) noexcept : counter_(other.counter()) {}
+
+    T* allocate(size_t n)
+    {
+        T* p = std::allocator<T>().allocate(n);
+        if (counter_)
+            counter_->fetch_add(n * sizeof(T), std::memory_order_relaxed);
+        return p;
+    }
+
+    void deallocate(T* p, size_t n) noexcept
+    {
+        if (counter_)
+            counter_->fetch_sub(n * sizeof(T), std::memory_order_relaxed);
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    AllocationCounter* counter() const noexcept { return counter_; }
+
+    template<typename U>
+    bool operator==(const CountingAllocator<U>& other) const noexcept { return counter_ == other.counter(); }
+
+    template<typename U>
+    bool operator!=(const CountingAllocator<U>& other) const noexcept { return counter_ != other.counter(); }
+
+private:
+    AllocationCounter* counter_ = nullptr;
+};
+
+// key / value 自己在堆上持有的字节数；分配器看不到这部分，按常见类型估算（短字符串优化的内联部分不计）
+template<typename T>
+size_t heapBytes(const T&) { return 0; }
+
+inline size_t heapBytes(const std::string& value)
+{
+    static const size_t kInline = std::string().capacity();
+    return value.capacity() > kInline ? value.capacity() + 1 : 0;
+}
+
+template<typename T, typename A>
+size_t heapBytes(const std::vector<T, A>& value)
+{
+    size_t bytes = value.capacity() * sizeof(T);
+    for (const T& element : value)
+        bytes += heapBytes(element);
+    return bytes;
+}
+
+// 可平凡拷贝的类型不持有堆内存，统计时不必逐个遍历条目
+template<typename T>
+inline constexpr bool kMayOwnHeap = !std::is_trivially_copyable_v<T>;
+
+}
@@ -0,0 +1,246 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "HashCaches.h"
+#include "LruBase.h"
+
+namespace MyCache
+{
+
+// 带负缓存的分片缓存：后端确认不存在的 key 记入每个分片的指纹表，在有效期内直接判定不存在，不再调用 loader。
+// 指纹表按 8 路组相联组织，每路一个 64 位原子量：高 32 位是指纹，低 32 位是以毫秒计的过期时刻；
+// 组满时顶替最早过期的一路。每个负条目只占 8 字节，代价是指纹冲突时另一个 key 可能在有效期内被误判为不存在。
+// put 会清除对应指纹。loader 执行期间若同一分片发生过 put，加载得到的"不存在"结果作废，避免把刚写入的 key 标成不存在。
+template<typename Key, typename Value, typename CacheType = LruBase<Key, Value>>
+class HashNegativeCaches
+{
+public:
+    struct Stats
+    {
+        uint64_t hits = 0;
+        uint64_t negativeHits = 0;
+        uint64_t loads = 0;
+        uint64_t negativeInserts = 0;
+    };
+
+    template<typename... Args>
+    HashNegativeCaches(size_t capacity, int sliceNum, size_t negativeCapacity,
+                       std::chrono::milliseconds negativeTtl, Args... args)
+        : caches_(capacity, sliceNum, args...)
+        , ttlMs_(static_cast<uint32_t>(std::max<int64_t>(1, negativeTtl.count())))
+        , start_(std::chrono::steady_clock::now())
+        , shards_(caches_.sliceNum())
+    {
+        size_t perShard = std::ceil(negativeCapacity / static_cast<double>(caches_.sliceNum()) / kWays);
+        size_t buckets = 1;
+        while (buckets < perShard)
+            buckets <<= 1;
+        for (auto& shard : shards_)
+        {
+            shard.buckets = std::make_unique<Bucket[]>(buckets);
+            shard.mask = buckets - 1;
+            shard.shift = std::min(63, 64 - std::countr_zero(buckets));
+        }
+    }
+
+    void put(Key key, Value value)
+    {
+        caches_.put(key, value);
+        invalidate(key);
+    }
+
+    bool get(Key key, Value& value) { return caches_.get(key, value); }
+    Value get(Key key) { return caches_.get(key); }
+
+    // 只删除正缓存，不记为不存在
+    void remove(Key key) { caches_.remove(key); }
+
+    // 调用方从其他途径确认 key 在后端不存在时直接记录
+    void markAbsent(const Key& key)
+    {
+        size_t hash = std::hash<Key>()(key);
+        insertNegative(shardOf(hash), hash);
+    }
+
+    bool isKnownAbsent(const Key& key)
+    {
+        size_t hash = std::hash<Key>()(key);
+        return findNegative(shardOf(hash), hash) != nullptr;
+    }
+
+    // loader(key) -> std::optional<Value>，返回空表示后端不存在；结果为空同样表示不存在
+    template<typename Loader>
+    std::optional<Value> getOrLoad(const Key& key, Loader loader)
+    {
+        Value value;
+        if (caches_.get(key, value))
+        {
+            ++hits_;
+            return value;
+        }
+
+        size_t hash = std::hash<Key>()(key);
+        Shard& shard = shardOf(hash);
+        if (findNegative(shard, hash))
+        {
+            ++negativeHits_;
+            return std::nullopt;
+        }
+
+        uint64_t generation = shard.generation.load();
+        ++loads_;
+        std::optional<Value> loaded = loader(key);
+        if (loaded)
+        {
+            put(key, *loaded);
+            return loaded;
+        }
+
+        // 先插入再复查：与 put 的"先递增代数再清除指纹"配合，任何交错下都不会留下过期的负条目
+        insertNegative(shard, hash);
+        if (shard.generation.load() != generation)
+            eraseNegative(shard, hash);
+        return std::nullopt;
+    }
+
+    Stats stats() const
+    {
+        return Stats{hits_, negativeHits_, loads_, negativeInserts_};
+    }
+
+    // 指纹表占用的字节数
+    size_t negativeBytes() const
+    {
+        return shards_.size() * (shards_.front().mask + 1) * sizeof(Bucket);
+    }
+
+    HashCaches<Key, Value, CacheType>& caches() { return caches_; }
+
+private:
+    static constexpr size_t kWays = 8;
+
+    struct alignas(64) Bucket
+    {
+        std::atomic<uint64_t> ways[kWays] = {};
+    };
+
+    struct Shard
+    {
+        std::unique_ptr<Bucket[]> buckets;
+        size_t                    mask = 0;
+        int                       shift = 63;
+        std::atomic<uint64_t>     generation{0};
+    };
+
+    Shard& shardOf(size_t hash) { return shards_[hash % shards_.size()]; }
+
+    // 分片已用掉散列值取模的结果，同一分片内低位相同：组号取乘法散列后的高位，
+    // 指纹取高低半交换后的散列值乘另一个常数的高位，两者互不相关；指纹为 0 表示空位
+    static Bucket& bucketOf(Shard& shard, size_t hash)
+    {
+        uint64_t mixed = static_cast<uint64_t>(hash) * 0x9E3779B97F4A7C15ULL;
+        return shard.buckets[(mixed >> shard.shift) & shard.mask];
+    }
+
+    static uint32_t fingerprintOf(size_t hash)
+    {
+        uint64_t rotated = std::rotl(static_cast<uint64_t>(hash), 32);
+        uint32_t fp = static_cast<uint32_t>((rotated * 0xC2B2AE3D27D4EB4FULL) >> 32);
+        return fp ? fp : 1;
+    }
+
+    uint32_t nowMs() const
+    {
+        return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start_).count());
+    }
+
+    // 过期时刻按 32 位回绕比较
+    static bool alive(uint64_t entry, uint32_t now)
+    {
+        return entry != 0 && static_cast<int32_t>(static_cast<uint32_t>(entry) - now) > 0;
+    }
+
+    std::atomic<uint64_t>* findNegative(Shard& shard, size_t hash)
+    {
+        uint32_t fp = fingerprintOf(hash);
+        uint32_t now = nowMs();
+        for (auto& way : bucketOf(shard, hash).ways)
+        {
+            uint64_t entry = way.load(std::memory_order_acquire);
+            if (static_cast<uint32_t>(entry >> 32) == fp && alive(entry, now))
+                return &way;
+        }
+        return nullptr;
+    }
+
+    void insertNegative(Shard& shard, size_t hash)
+    {
+        uint32_t fp = fingerprintOf(hash);
+        uint32_t now = nowMs();
+        uint64_t entry = static_cast<uint64_t>(fp) << 32 | static_cast<uint32_t>(now + ttlMs_);
+        Bucket& bucket = bucketOf(shard, hash);
+
+        // 优先复用同指纹的一路，其次是空位或已过期的，最后顶替剩余有效期最短的
+        std::atomic<uint64_t>* target = nullptr;
+        int32_t shortest = INT32_MAX;
+        for (auto& way : bucket.ways)
+        {
+            uint64_t current = way.load(std::memory_order_relaxed);
+            if (static_cast<uint32_t>(current >> 32) == fp)
+            {
+                target = &way;
+                break;
+            }
+            int32_t remaining = alive(current, now) ? static_cast<int32_t>(static_cast<uint32_t>(current) - now) : 0;
+            if (remaining < shortest)
+            {
+                shortest = remaining;
+                target = &way;
+            }
+        }
+        target->store(entry, std::memory_order_release);
+        ++negativeInserts_;
+    }
+
+    void eraseNegative(Shard& shard, size_t hash)
+    {
+        uint32_t fp = fingerprintOf(hash);
+        for (auto& way : bucketOf(shard, hash).ways)
+        {
+            uint64_t entry = way.load(std::memory_order_acquire);
+            if (static_cast<uint32_t>(entry >> 32) == fp)
+                way.compare_exchange_strong(entry, 0);
+        }
+    }
+
+    void invalidate(const Key& key)
+    {
+        size_t hash = std::hash<Key>()(key);
+        Shard& shard = shardOf(hash);
+        shard.generation.fetch_add(1);
+        eraseNegative(shard, hash);
+    }
+
+private:
+    HashCaches<Key, Value, CacheType>     caches_;
+    uint32_t                              ttlMs_;
+    std::chrono::steady_clock::time_point start_;
+    std::vector<Shard>                    shards_;
+    std::atomic<uint64_t>                 hits_{0};
+    std::atomic<uint64_t>                 negativeHits_{0};
+    std::atomic<uint64_t>                 loads_{0};
+    std::atomic<uint64_t>                 negativeInserts_{0};
+};
+
+}
@@ -0,0 +1,223 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+#include "CacheSer.h"
+#include "GhostFifo.h"
+#include "HashCaches.h"
+
+namespace MyCache
+{
+
+// S3-FIFO：新 key 先进小队列 small_（约容量的 10%），被淘汰时若期间访问过则转入主队列 main_，
+// 否则只把指纹留在幽灵队列；幽灵命中的 key 再次写入时直接进主队列。
+// 主队列淘汰时按访问计数重新插回队尾。命中只在读锁下给原子计数加一，不移动任何链表。
+template<typename Key, typename Value>
+class S3FifoCache : public CacheSer<Key, Value>
+{
+private:
+    struct Node
+    {
+        Key                  key;
+        Value                value;
+        std::atomic<uint8_t> freq;
+        bool                 inMain;
+        bool                 removed;
+
+        Node(const Key& key, const Value& value)
+            : key(key), value(value), freq(0), inMain(false), removed(false) {}
+    };
+
+    using NodeQueue = std::deque<std::unique_ptr<Node>>;
+
+public:
+    explicit S3FifoCache(int capacity, double smallRatio = 0.1)
+        : capacity_(std::max(capacity, 0))
+        , smallCapacity_(std::max<size_t>(1, static_cast<size_t>(capacity_ * smallRatio)))
+        , ghost_(capacity_ > smallCapacity_ ? capacity_ - smallCapacity_ : capacity_)
+        , smallLive_(0)
+        , mainLive_(0)
+    {}
+
+    ~S3FifoCache() override = default;
+
+    void put(Key key, Value value) override
+    {
+        if (capacity_ == 0)
+            return;
+
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        auto it = nodeMap_.find(key);
+        if (it != nodeMap_.end())
+        {
+            it->second->value = value;
+            touch(it->second);
+            return;
+        }
+
+        while (smallLive_ + mainLive_ >= capacity_)
+        {
+            evict();
+        }
+
+        auto node = std::make_unique<Node>(key, value);
+        nodeMap_[key] = node.get();
+        uint64_t fp = GhostFifo::fingerprint(key);
+        if (ghost_.erase(fp))
+        {
+            node->inMain = true;
+            main_.push_back(std::move(node));
+            ++mainLive_;
+        }
+        else
+        {
+            small_.push_back(std::move(node));
+            ++smallLive_;
+        }
+    }
+
+    bool get(Key key, Value& value) override
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto it = nodeMap_.find(key);
+        if (it == nodeMap_.end())
+            return false;
+
+        touch(it->second);
+        value = it->second->value;
+        return true;
+    }
+
+    Value get(Key key) override
+    {
+        Value value{};
+        get(key, value);
+        return value;
+    }
+
+    void remove(Key key)
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        auto it = nodeMap_.find(key);
+        if (it == nodeMap_.end())
+            return;
+
+        it->second->removed = true;
+        --(it->second->inMain ? mainLive_ : smallLive_);
+        nodeMap_.erase(it);
+        compactIfSparse();
+    }
+
+private:
+    static constexpr uint8_t kMaxFreq = 3;
+
+    static void touch(Node* node)
+    {
+        uint8_t freq = node->freq.load(std::memory_order_relaxed);
+        if (freq < kMaxFreq)
+            node->freq.store(freq + 1, std::memory_order_relaxed);
+    }
+
+    void evict()
+    {
+        while (true)
+        {
+            if (!small_.empty() && (smallLive_ >= smallCapacity_ || main_.empty()))
+            {
+                if (evictSmall())
+                    return;
+            }
+            else if (!main_.empty())
+            {
+                if (evictMain())
+                    return;
+            }
+            else
+            {
+                return;
+            }
+        }
+    }
+
+    // 返回 true 表示真正淘汰了一个条目
+    bool evictSmall()
+    {
+        std::unique_ptr<Node> node = std::move(small_.front());
+        small_.pop_front();
+        if (node->removed)
+            return false;
+
+        --smallLive_;
+        if (node->freq.load(std::memory_order_relaxed) > 0)
+        {
+            node->freq.store(0, std::memory_order_relaxed);
+            node->inMain = true;
+            main_.push_back(std::move(node));
+            ++mainLive_;
+            return false;
+        }
+
+        ghost_.insert(GhostFifo::fingerprint(node->key));
+        nodeMap_.erase(node->key);
+        return true;
+    }
+
+    bool evictMain()
+    {
+        std::unique_ptr<Node> node = std::move(main_.front());
+        main_.pop_front();
+        if (node->removed)
+            return false;
+
+        uint8_t freq = node->freq.load(std::memory_order_relaxed);
+        if (freq > 0)
+        {
+            node->freq.store(freq - 1, std::memory_order_relaxed);
+            main_.push_back(std::move(node));
+            return false;
+        }
+
+        --mainLive_;
+        nodeMap_.erase(node->key);
+        return true;
+    }
+
+    // remove 只做标记，被标记的节点过多时整理一次队列并修正计数
+    void compactIfSparse()
+    {
+        if (small_.size() + main_.size() <= 2 * nodeMap_.size() + 16)
+            return;
+
+        auto dropRemoved = [](NodeQueue& queue) {
+            queue.erase(std::remove_if(queue.begin(), queue.end(),
+                                       [](const std::unique_ptr<Node>& node) { return node->removed; }),
+                        queue.end());
+        };
+        dropRemoved(small_);
+        dropRemoved(main_);
+        smallLive_ = small_.size();
+        mainLive_ = main_.size();
+    }
+
+private:
+    size_t                          capacity_;
+    size_t                          smallCapacity_;
+    GhostFifo                       ghost_;
+    size_t                          smallLive_;
+    size_t                          mainLive_;
+    std::shared_mutex               mutex_;
+    std::unordered_map<Key, Node*>  nodeMap_;
+    NodeQueue                       small_;
+    NodeQueue                       main_;
+};
+
+template<typename Key, typename Value>
+using HashS3FifoCaches = HashCaches<Key, Value, S3FifoCache<Key, Value>>;
+
+}
@@ -0,0 +1,339 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "CacheOps.h"
+#include "CacheSer.h"
+#include "MemoryUsage.h"
+
+namespace MyCache
+{
+
+enum class SampledPolicy { Lru, Lfu };
+
+// 采样淘汰的近似 LRU / LFU（做法同 Redis）：条目紧凑地存放在数组里，每个条目只多带一个 32 位的访问标记，
+// 索引是存数组下标的开放寻址表，没有链表指针与逐条目的堆分配。
+// 淘汰时随机抽取 samples 个条目，按空闲时长（LRU）或衰减后的对数访问计数（LFU）评分，
+// 较好的候选留在跨轮次保留的淘汰池中，每次淘汰池里最该淘汰且此后未被访问过的那个。
+// 默认每轮抽 10 个、池大小 16，命中率与精确 LRU 相差很小；抽样数越少越快，近似程度也越差。
+// LRU 模式的标记是 32 位访问时钟；LFU 模式低 8 位是对数计数，高 24 位是上次衰减的时刻，每经过 capacity 次访问计数减一。
+template<typename Key, typename Value>
+class SampledCache : public CacheSer<Key, Value>, public CacheOps<SampledCache<Key, Value>, Key, Value>
+{
+public:
+    explicit SampledCache(size_t capacity, SampledPolicy policy = SampledPolicy::Lru, size_t samples = 10,
+                          size_t poolSize = 16)
+        : capacity_(capacity)
+        , policy_(policy)
+        , samples_(std::max<size_t>(1, samples))
+        , poolSize_(std::max<size_t>(1, poolSize))
+    {
+        size_t tableSize = 8;
+        while (tableSize < capacity + capacity / 2)
+            tableSize <<= 1;
+        table_.assign(tableSize, kEmpty);
+        mask_ = tableSize - 1;
+        for (size_t size = tableSize; size > 1; size >>= 1)
+            --shift_;
+        entries_.reserve(capacity);
+        pool_.reserve(poolSize_ + 1);
+    }
+
+    ~SampledCache() override = default;
+
+    void put(Key key, Value value) override
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        putInternal(key, value);
+    }
+
+    bool get(Key key, Value& value) override
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t pos = find(key);
+        if (pos == npos)
+            return false;
+        Entry& entry = entries_[table_[pos]];
+        touch(entry);
+        value = entry.value;
+        return true;
+    }
+
+    Value get(Key key) override
+    {
+        Value value{};
+        get(key, value);
+        return value;
+    }
+
+    void remove(Key key)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t pos = find(key);
+        if (pos != npos)
+            removeAt(pos);
+    }
+
+    // 原子读改写的底层原语，见 CacheOps.h
+    template<typename Fn>
+    void mutate(const Key& key, Fn fn)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t pos = find(key);
+        Mutation<Value> mutation = fn(pos != npos ? &entries_[table_[pos]].value : nullptr);
+        switch (mutation.kind)
+        {
+        case Mutation<Value>::Kind::Keep:
+            if (pos != npos)
+                touch(entries_[table_[pos]]);
+            break;
+        case Mutation<Value>::Kind::Set:
+            putInternal(key, mutation.value);
+            break;
+        case Mutation<Value>::Kind::Remove:
+            if (pos != npos)
+                removeAt(pos);
+            break;
+        }
+    }
+
+    size_t size()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return entries_.size();
+    }
+
+    // 条目数组按容量一次预留，未用满的部分计入元数据
+    MemoryUsage memoryUsage()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        MemoryUsage usage;
+        usage.entries = entries_.size();
+        usage.indexBytes = table_.capacity() * sizeof(uint32_t);
+        usage.payloadBytes = usage.entries * (sizeof(Key) + sizeof(Value));
+        usage.metadataBytes = entries_.capacity() * sizeof(Entry) - usage.payloadBytes
+                            + pool_.capacity() * sizeof(Candidate);
+        if constexpr (kMayOwnHeap<Key> || kMayOwnHeap<Value>)
+        {
+            for (const Entry& entry : entries_)
+                usage.payloadBytes += heapBytes(entry.key) + heapBytes(entry.value);
+            for (const Candidate& candidate : pool_)
+                usage.metadataBytes += heapBytes(candidate.key);
+        }
+        return usage;
+    }
+
+private:
+    static constexpr uint32_t kEmpty = UINT32_MAX;
+    static constexpr size_t   npos = static_cast<size_t>(-1);
+    // 新条目的初始计数，避免刚插入就因计数为 0 被淘汰
+    static constexpr uint32_t kLfuInit = 5;
+    static constexpr double   kLfuLogFactor = 10;
+
+    struct Entry
+    {
+        Key      key;
+        Value    value;
+        uint32_t stamp;
+    };
+
+    // 淘汰池按当前评分升序排列，越靠后越该淘汰；评分由入池时的 stamp 随时钟算出，
+    // 未被访问的条目之间先后关系不随时间改变。stamp 也用来确认候选在入池后没有被访问过
+    struct Candidate
+    {
+        Key      key;
+        uint32_t stamp;
+    };
+
+    void putInternal(const Key& key, const Value& value)
+    {
+        if (capacity_ == 0)
+            return;
+
+        size_t pos = find(key);
+        if (pos != npos)
+        {
+            Entry& entry = entries_[table_[pos]];
+            entry.value = value;
+            touch(entry);
+            return;
+        }
+
+        if (entries_.size() >= capacity_)
+            evictOne();
+
+        pos = home(key);
+        while (table_[pos] != kEmpty)
+            pos = (pos + 1) & mask_;
+        table_[pos] = static_cast<uint32_t>(entries_.size());
+        entries_.push_back(Entry{key, value, initialStamp()});
+    }
+
+    uint32_t initialStamp()
+    {
+        ++clock_;
+        if (policy_ == SampledPolicy::Lru)
+            return static_cast<uint32_t>(clock_);
+        return (tick() << 8) | kLfuInit;
+    }
+
+    void touch(Entry& entry)
+    {
+        ++clock_;
+        if (policy_ == SampledPolicy::Lru)
+        {
+            entry.stamp = static_cast<uint32_t>(clock_);
+            return;
+        }
+
+        // 先按经过的衰减周期扣减，再按对数概率加一：计数越大，加一的概率越小
+        uint32_t counter = decayedCounter(entry.stamp);
+        if (counter < 255)
+        {
+            double base = counter > kLfuInit ? counter - kLfuInit : 0;
+            double random = (nextRandom() >> 11) * 0x1.0p-53;
+            if (random < 1.0 / (base * kLfuLogFactor + 1))
+                ++counter;
+        }
+        entry.stamp = (tick() << 8) | counter;
+    }
+
+    // 24 位的衰减时刻，每 capacity 次访问前进一格
+    uint32_t tick() const
+    {
+        return static_cast<uint32_t>(clock_ / std::max<size_t>(capacity_, 1)) & 0xFFFFFF;
+    }
+
+    uint32_t decayedCounter(uint32_t stamp) const
+    {
+        uint32_t counter = stamp & 0xFF;
+        uint32_t elapsed = (tick() - (stamp >> 8)) & 0xFFFFFF;
+        return elapsed >= counter ? 0 : counter - elapsed;
+    }
+
+    // 越大越该淘汰：LRU 为空闲的访问次数，LFU 为 255 减去衰减后的计数
+    uint32_t scoreOf(uint32_t stamp) const
+    {
+        if (policy_ == SampledPolicy::Lru)
+            return static_cast<uint32_t>(clock_) - stamp;
+        return 255 - decayedCounter(stamp);
+    }
+
+    void evictOne()
+    {
+        while (true)
+        {
+            refillPool();
+            while (!pool_.empty())
+            {
+                Candidate best = std::move(pool_.back());
+                pool_.pop_back();
+                size_t pos = find(best.key);
+                if (pos != npos && entries_[table_[pos]].stamp == best.stamp)
+                {
+                    removeAt(pos);
+                    return;
+                }
+            }
+        }
+    }
+
+    void refillPool()
+    {
+        for (size_t i = 0; i < samples_; ++i)
+        {
+            const Entry& entry = entries_[nextRandom() % entries_.size()];
+            uint32_t score = scoreOf(entry.stamp);
+            if (pool_.size() >= poolSize_ && score <= scoreOf(pool_.front().stamp))
+                continue;
+
+            auto same = std::find_if(pool_.begin(), pool_.end(),
+                                     [&](const Candidate& candidate) { return candidate.key == entry.key; });
+            if (same != pool_.end())
+                pool_.erase(same);
+
+            auto at = std::upper_bound(pool_.begin(), pool_.end(), score, [this](uint32_t value, const Candidate& candidate) {
+                return value < scoreOf(candidate.stamp);
+            });
+            pool_.insert(at, Candidate{entry.key, entry.stamp});
+            if (pool_.size() > poolSize_)
+                pool_.erase(pool_.begin());
+        }
+    }
+
+    size_t home(const Key& key) const
+    {
+        return (std::hash<Key>()(key) * 0x9E3779B97F4A7C15ULL) >> shift_;
+    }
+
+    // 返回 key 在索引表中的位置
+    size_t find(const Key& key) const
+    {
+        for (size_t pos = home(key); table_[pos] != kEmpty; pos = (pos + 1) & mask_)
+        {
+            if (entries_[table_[pos]].key == key)
+                return pos;
+        }
+        return npos;
+    }
+
+    // 删除索引表 pos 处的条目：数组中用最后一个条目填洞，索引表做线性探测的反向移位删除
+    void removeAt(size_t pos)
+    {
+        uint32_t index = table_[pos];
+        uint32_t last = static_cast<uint32_t>(entries_.size() - 1);
+        eraseSlot(pos);
+        if (index != last)
+        {
+            size_t moved = find(entries_[last].key);
+            table_[moved] = index;
+            entries_[index] = std::move(entries_[last]);
+        }
+        entries_.pop_back();
+    }
+
+    void eraseSlot(size_t hole)
+    {
+        for (size_t next = (hole + 1) & mask_; table_[next] != kEmpty; next = (next + 1) & mask_)
+        {
+            size_t want = home(entries_[table_[next]].key);
+            bool movable = (next > hole) ? (want <= hole || want > next)
+                                         : (want <= hole && want > next);
+            if (movable)
+            {
+                table_[hole] = table_[next];
+                hole = next;
+            }
+        }
+        table_[hole] = kEmpty;
+    }
+
+    uint64_t nextRandom()
+    {
+        rng_ ^= rng_ >> 12;
+        rng_ ^= rng_ << 25;
+        rng_ ^= rng_ >> 27;
+        return rng_ * 0x2545F4914F6CDD1DULL;
+    }
+
+private:
+    size_t                 capacity_;
+    SampledPolicy          policy_;
+    size_t                 samples_;
+    size_t                 poolSize_;
+    std::mutex             mutex_;
+    std::vector<Entry>     entries_;
+    std::vector<uint32_t>  table_;
+    size_t                 mask_ = 0;
+    int                    shift_ = 64;
+    uint64_t               clock_ = 0;
+    uint64_t               rng_ = 0x9E3779B97F4A7C15ULL;
+    std::vector<Candidate> pool_;
+};
+
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+#include <vector>
+
+namespace MyCache
+{
+
+// 识别扫描式访问，供策略在插入新 key 时决定是否降级为低优先级插入：
+// 1. 整数 key 以相同的非零步长连续变化达到 runThreshold 次视为顺序扫描（分片后同一分片内的顺序扫描表现为固定步长）；
+// 2. 最近 window 次插入中从未见过的 key 占比达到 newKeyRatio 视为一次性批量访问。
+// 历史过滤器为两次探测的位图，记录的 key 数超过位数的八分之一时清空，只保留近期的历史。
+template<typename Key>
+class ScanDetector
+{
+public:
+    explicit ScanDetector(size_t capacity, size_t runThreshold = 8, size_t window = 64, double newKeyRatio = 0.9)
+        : runThreshold_(runThreshold)
+        , window_(std::max<size_t>(window, 1))
+        , newKeyLimit_(static_cast<size_t>(newKeyRatio * window_))
+        , bits_(bitCount(capacity) / 64, 0)
+        , mask_(bitCount(capacity) - 1)
+        , shift_(64 - log2Of(bitCount(capacity)))
+        , recent_(window_, 0)
+    {}
+
+    // 在插入新 key 时调用，返回 true 表示当前处于扫描中
+    bool onInsert(const Key& key)
+    {
+        bool sequential = updateRun(key);
+
+        // 分片按散列值取模，同一分片内 key 的散列低位相同，两次探测都取乘法散列后的高位
+        uint64_t hash = static_cast<uint64_t>(std::hash<Key>()(key)) * 0x9E3779B97F4A7C15ULL;
+        size_t h1 = static_cast<size_t>(hash >> shift_);
+        size_t h2 = static_cast<size_t>(hash >> (2 * shift_ - 64)) & mask_;
+        bool seen = testBit(h1) && testBit(h2);
+        if (!seen)
+        {
+            setBit(h1);
+            setBit(h2);
+            if (++remembered_ > (mask_ + 1) / 8)
+                resetHistory();
+        }
+
+        newInWindow_ -= recent_[cursor_];
+        recent_[cursor_] = seen ? 0 : 1;
+        newInWindow_ += recent_[cursor_];
+        cursor_ = (cursor_ + 1) % window_;
+        if (filled_ < window_)
+            ++filled_;
+
+        return sequential || (filled_ == window_ && newInWindow_ >= newKeyLimit_);
+    }
+
+private:
+    static constexpr size_t kMaxBits = 1 << 20;
+
+    static size_t bitCount(size_t capacity)
+    {
+        size_t bits = 1024;
+        while (bits < capacity * 8 && bits < kMaxBits)
+            bits <<= 1;
+        return bits;
+    }
+
+    static int log2Of(size_t bits)
+    {
+        int log = 0;
+        while ((size_t(1) << log) < bits)
+            ++log;
+        return log;
+    }
+
+    bool updateRun(const Key& key)
+    {
+        if constexpr (kTrackRuns)
+        {
+            // 转成无符号再相减，避免有符号溢出；步长按模 2^N 比较，结果不变
+            Delta delta = static_cast<Delta>(static_cast<Delta>(key) - static_cast<Delta>(lastKey_));
+            if (hasLast_ && delta != 0 && delta == lastDelta_)
+                ++run_;
+            else
+                run_ = 0;
+            lastDelta_ = delta;
+            lastKey_ = key;
+            hasLast_ = true;
+            return run_ >= runThreshold_;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    bool testBit(size_t bit) const { return bits_[bit / 64] >> (bit % 64) & 1; }
+    void setBit(size_t bit) { bits_[bit / 64] |= 1ULL << (bit % 64); }
+
+    void resetHistory()
+    {
+        std::fill(bits_.begin(), bits_.end(), 0);
+        remembered_ = 0;
+    }
+
+private:
+    static constexpr bool kTrackRuns = std::is_integral_v<Key> && !std::is_same_v<Key, bool>;
+    using Delta = typename std::conditional_t<kTrackRuns, std::make_unsigned<Key>, std::type_identity<Key>>::type;
+
+    size_t                runThreshold_;
+    size_t                window_;
+    size_t                newKeyLimit_;
+    std::vector<uint64_t> bits_;
+    size_t                mask_;
+    int                   shift_;
+    size_t                remembered_ = 0;
+    std::vector<uint8_t>  recent_;
+    size_t                cursor_ = 0;
+    size_t                filled_ = 0;
+    size_t                newInWindow_ = 0;
+    Key                   lastKey_{};
+    Delta                 lastDelta_{};
+    bool                  hasLast_ = false;
+    size_t                run_ = 0;
+};
+
+}
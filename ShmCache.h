@@ -0,0 +1,533 @@
+#pragma once
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include "CacheOps.h"
+#include "FileTier.h"
+
+namespace MyCache
+{
+
+// 多进程共享的分片 LRU：索引、LRU 链表和值全部放在一个 POSIX 共享内存段里，同一台机器上的进程打开同名段即共享一份缓存。
+// 各进程映射地址不同，段内只保存相对分片起点的槽位下标，不保存指针。每个分片一把进程间共享的健壮互斥锁，
+// 持锁进程崩溃后下一个加锁者拿到 EOWNERDEAD，把该分片清空重建后再标记锁恢复一致（缓存内容可以丢，结构不能坏）。
+// key 与值按 TierCodec 编码后存入定长槽位，超过 maxKeyBytes / maxValueBytes 的条目不缓存；
+// 哈希使用 std::hash，要求所有进程使用同一份标准库。
+template<typename Key, typename Value>
+class HashShmCaches : public CacheOps<HashShmCaches<Key, Value>, Key, Value>
+{
+public:
+    struct Stats
+    {
+        uint64_t size = 0;
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t rejected = 0;
+        uint64_t recoveries = 0;
+    };
+
+    // 段不存在时创建并初始化，已存在时直接打开，参数必须与创建者一致
+    HashShmCaches(const std::string& name, size_t capacity, int sliceNum,
+                  size_t maxValueBytes = 256, size_t maxKeyBytes = 64)
+    {
+        Layout layout = makeLayout(capacity, sliceNum, maxKeyBytes, maxValueBytes);
+        int fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+        bool creator = fd >= 0;
+        if (!creator && errno == EEXIST)
+            fd = ::shm_open(name.c_str(), O_RDWR, 0600);
+        if (fd < 0)
+            throw std::runtime_error("cannot open shared memory " + name);
+
+        if (creator && ::ftruncate(fd, layout.totalBytes) != 0)
+        {
+            ::close(fd);
+            ::shm_unlink(name.c_str());
+            throw std::runtime_error("cannot size shared memory " + name);
+        }
+        if (!creator && !waitForSize(fd, layout.totalBytes))
+        {
+            ::close(fd);
+            throw std::runtime_error("shared memory " + name + " has a different layout");
+        }
+
+        void* mem = ::mmap(nullptr, layout.totalBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (mem == MAP_FAILED)
+            throw std::runtime_error("cannot map shared memory " + name);
+        base_ = static_cast<char*>(mem);
+        mappedBytes_ = layout.totalBytes;
+
+        if (creator)
+        {
+            initSegment(layout);
+        }
+        else if (!waitForReady() || !sameLayout(layout))
+        {
+            ::munmap(base_, mappedBytes_);
+            throw std::runtime_error("shared memory " + name + " has a different layout");
+        }
+    }
+
+    ~HashShmCaches()
+    {
+        ::munmap(base_, mappedBytes_);
+    }
+
+    HashShmCaches(const HashShmCaches&) = delete;
+    HashShmCaches& operator=(const HashShmCaches&) = delete;
+
+    // 删除共享内存名字，已映射的进程不受影响
+    static void destroy(const std::string& name)
+    {
+        ::shm_unlink(name.c_str());
+    }
+
+    void put(Key key, Value value)
+    {
+        std::string keyBytes;
+        TierCodec<Key>::encode(key, keyBytes);
+        std::string valueBytes;
+        TierCodec<Value>::encode(value, valueBytes);
+        uint64_t hash = std::hash<Key>()(key);
+
+        ShardLock lock(*this, hash);
+        store(lock.shard, hash, keyBytes, valueBytes);
+    }
+
+    bool get(Key key, Value& value)
+    {
+        std::string keyBytes;
+        TierCodec<Key>::encode(key, keyBytes);
+        uint64_t hash = std::hash<Key>()(key);
+
+        ShardLock lock(*this, hash);
+        ShardHeader* shard = lock.shard;
+        uint32_t index = find(shard, hash, keyBytes);
+        if (index == kNil || !TierCodec<Value>::decode(valueOf(shard, index), value))
+        {
+            ++shard->misses;
+            return false;
+        }
+        moveToHead(shard, index);
+        ++shard->hits;
+        return true;
+    }
+
+    Value get(Key key)
+    {
+        Value value{};
+        get(key, value);
+        return value;
+    }
+
+    void remove(Key key)
+    {
+        std::string keyBytes;
+        TierCodec<Key>::encode(key, keyBytes);
+        uint64_t hash = std::hash<Key>()(key);
+
+        ShardLock lock(*this, hash);
+        uint32_t index = find(lock.shard, hash, keyBytes);
+        if (index != kNil)
+            release(lock.shard, index);
+    }
+
+    // 回调在分片锁内执行；回调中进程退出时分片会在下次加锁时被重建
+    template<typename Fn>
+    void mutate(const Key& key, Fn fn)
+    {
+        std::string keyBytes;
+        TierCodec<Key>::encode(key, keyBytes);
+        uint64_t hash = std::hash<Key>()(key);
+
+        ShardLock lock(*this, hash);
+        ShardHeader* shard = lock.shard;
+        uint32_t index = find(shard, hash, keyBytes);
+        Value current{};
+        bool present = index != kNil && TierCodec<Value>::decode(valueOf(shard, index), current);
+
+        Mutation<Value> mutation = fn(present ? &current : nullptr);
+        if (mutation.kind == Mutation<Value>::Kind::Set)
+        {
+            std::string valueBytes;
+            TierCodec<Value>::encode(mutation.value, valueBytes);
+            store(shard, hash, keyBytes, valueBytes);
+        }
+        else if (mutation.kind == Mutation<Value>::Kind::Remove)
+        {
+            if (index != kNil)
+                release(shard, index);
+        }
+        else if (present)
+        {
+            moveToHead(shard, index);
+        }
+    }
+
+    Stats stats()
+    {
+        Stats total;
+        for (uint32_t i = 0; i < header()->sliceNum; ++i)
+        {
+            ShardLock lock(*this, shardAt(i));
+            total.size += lock.shard->size;
+            total.hits += lock.shard->hits;
+            total.misses += lock.shard->misses;
+            total.rejected += lock.shard->rejected;
+            total.recoveries += lock.shard->recoveries;
+        }
+        return total;
+    }
+
+    int sliceNum() const { return static_cast<int>(header()->sliceNum); }
+
+private:
+    static constexpr uint64_t kMagic = 0x4D79436163686553ULL;
+    static constexpr uint32_t kReady = 1;
+    static constexpr uint32_t kNil = UINT32_MAX;
+
+    struct SegmentHeader
+    {
+        uint64_t              magic;
+        std::atomic<uint32_t> state;
+        uint32_t              sliceNum;
+        uint32_t              slotsPerShard;
+        uint32_t              bucketsPerShard;
+        uint32_t              maxKeyBytes;
+        uint32_t              maxValueBytes;
+        uint64_t              slotBytes;
+        uint64_t              shardBytes;
+    };
+
+    // 链表与哈希链都用槽位下标，kNil 表示空
+    struct ShardHeader
+    {
+        pthread_mutex_t mutex;
+        uint32_t        head;
+        uint32_t        tail;
+        uint32_t        freeHead;
+        uint32_t        size;
+        uint64_t        hits;
+        uint64_t        misses;
+        uint64_t        rejected;
+        uint64_t        recoveries;
+    };
+
+    // 槽位头之后依次是 key 字节和值字节
+    struct SlotHeader
+    {
+        uint32_t prev;
+        uint32_t next;
+        uint32_t hashNext;
+        uint32_t keyLen;
+        uint32_t valueLen;
+        uint32_t reserved;
+        uint64_t hash;
+    };
+
+    struct Layout
+    {
+        uint32_t sliceNum;
+        uint32_t slotsPerShard;
+        uint32_t bucketsPerShard;
+        uint32_t maxKeyBytes;
+        uint32_t maxValueBytes;
+        uint64_t slotBytes;
+        uint64_t shardBytes;
+        uint64_t totalBytes;
+    };
+
+    struct ShardLock
+    {
+        ShardLock(HashShmCaches& owner, uint64_t hash)
+            : ShardLock(owner, owner.shardAt(hash % owner.header()->sliceNum))
+        {}
+
+        ShardLock(HashShmCaches& owner, ShardHeader* target)
+            : shard(target)
+        {
+            int rc = ::pthread_mutex_lock(&shard->mutex);
+            if (rc == EOWNERDEAD)
+            {
+                // 上一个持锁者在修改途中退出，分片内容不可信，整体清空
+                uint64_t recoveries = shard->recoveries;
+                owner.resetShard(shard);
+                shard->recoveries = recoveries + 1;
+                ::pthread_mutex_consistent(&shard->mutex);
+            }
+            else if (rc != 0)
+            {
+                throw std::runtime_error("cannot lock shared cache shard");
+            }
+        }
+
+        ~ShardLock()
+        {
+            ::pthread_mutex_unlock(&shard->mutex);
+        }
+
+        ShardLock(const ShardLock&) = delete;
+        ShardLock& operator=(const ShardLock&) = delete;
+
+        ShardHeader* shard;
+    };
+
+    static uint64_t alignUp(uint64_t size) { return (size + 63) & ~uint64_t(63); }
+
+    static Layout makeLayout(size_t capacity, int sliceNum, size_t maxKeyBytes, size_t maxValueBytes)
+    {
+        Layout layout;
+        layout.sliceNum = sliceNum > 0 ? sliceNum : std::max(1u, std::thread::hardware_concurrency());
+        layout.slotsPerShard = std::max<uint32_t>(1, std::ceil(capacity / static_cast<double>(layout.sliceNum)));
+        layout.bucketsPerShard = 1;
+        while (layout.bucketsPerShard < layout.slotsPerShard)
+            layout.bucketsPerShard <<= 1;
+        layout.maxKeyBytes = maxKeyBytes;
+        layout.maxValueBytes = maxValueBytes;
+        layout.slotBytes = (sizeof(SlotHeader) + maxKeyBytes + maxValueBytes + 7) & ~uint64_t(7);
+        layout.shardBytes = alignUp(sizeof(ShardHeader)) + alignUp(layout.bucketsPerShard * sizeof(uint32_t))
+                          + alignUp(layout.slotsPerShard * layout.slotBytes);
+        layout.totalBytes = alignUp(sizeof(SegmentHeader)) + layout.sliceNum * layout.shardBytes;
+        return layout;
+    }
+
+    // 创建者先 ftruncate 再映射初始化，打开者等待段长度和就绪标记
+    static bool waitForSize(int fd, uint64_t expected)
+    {
+        for (int i = 0; i < 1000; ++i)
+        {
+            struct stat st;
+            if (::fstat(fd, &st) != 0)
+                return false;
+            if (static_cast<uint64_t>(st.st_size) == expected)
+                return true;
+            if (st.st_size != 0)
+                return false;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return false;
+    }
+
+    bool waitForReady()
+    {
+        for (int i = 0; i < 1000; ++i)
+        {
+            if (header()->state.load(std::memory_order_acquire) == kReady)
+                return true;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return false;
+    }
+
+    bool sameLayout(const Layout& layout) const
+    {
+        const SegmentHeader* h = header();
+        return h->magic == kMagic && h->sliceNum == layout.sliceNum && h->slotsPerShard == layout.slotsPerShard
+            && h->maxKeyBytes == layout.maxKeyBytes && h->maxValueBytes == layout.maxValueBytes;
+    }
+
+    void initSegment(const Layout& layout)
+    {
+        SegmentHeader* h = new (base_) SegmentHeader{};
+        h->magic = kMagic;
+        h->sliceNum = layout.sliceNum;
+        h->slotsPerShard = layout.slotsPerShard;
+        h->bucketsPerShard = layout.bucketsPerShard;
+        h->maxKeyBytes = layout.maxKeyBytes;
+        h->maxValueBytes = layout.maxValueBytes;
+        h->slotBytes = layout.slotBytes;
+        h->shardBytes = layout.shardBytes;
+
+        pthread_mutexattr_t attr;
+        ::pthread_mutexattr_init(&attr);
+        ::pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+        ::pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+        for (uint32_t i = 0; i < layout.sliceNum; ++i)
+        {
+            ShardHeader* shard = shardAt(i);
+            ::pthread_mutex_init(&shard->mutex, &attr);
+            resetShard(shard);
+            shard->recoveries = 0;
+        }
+        ::pthread_mutexattr_destroy(&attr);
+        h->state.store(kReady, std::memory_order_release);
+    }
+
+    // 需持有分片锁：清空哈希桶与计数，所有槽位串成空闲链
+    void resetShard(ShardHeader* shard)
+    {
+        const SegmentHeader* h = header();
+        std::fill(buckets(shard), buckets(shard) + h->bucketsPerShard, kNil);
+        for (uint32_t i = 0; i < h->slotsPerShard; ++i)
+        {
+            slot(shard, i)->next = i + 1 < h->slotsPerShard ? i + 1 : kNil;
+        }
+        shard->head = kNil;
+        shard->tail = kNil;
+        shard->freeHead = 0;
+        shard->size = 0;
+        shard->hits = 0;
+        shard->misses = 0;
+        shard->rejected = 0;
+    }
+
+    SegmentHeader* header() const { return reinterpret_cast<SegmentHeader*>(base_); }
+
+    ShardHeader* shardAt(uint32_t index) const
+    {
+        return reinterpret_cast<ShardHeader*>(base_ + alignUp(sizeof(SegmentHeader)) + index * header()->shardBytes);
+    }
+
+    uint32_t* buckets(ShardHeader* shard) const
+    {
+        return reinterpret_cast<uint32_t*>(reinterpret_cast<char*>(shard) + alignUp(sizeof(ShardHeader)));
+    }
+
+    SlotHeader* slot(ShardHeader* shard, uint32_t index) const
+    {
+        const SegmentHeader* h = header();
+        char* slots = reinterpret_cast<char*>(buckets(shard)) + alignUp(h->bucketsPerShard * sizeof(uint32_t));
+        return reinterpret_cast<SlotHeader*>(slots + index * h->slotBytes);
+    }
+
+    char* keyOf(ShardHeader* shard, uint32_t index) const
+    {
+        return reinterpret_cast<char*>(slot(shard, index) + 1);
+    }
+
+    std::string_view valueOf(ShardHeader* shard, uint32_t index) const
+    {
+        SlotHeader* s = slot(shard, index);
+        return std::string_view(keyOf(shard, index) + header()->maxKeyBytes, s->valueLen);
+    }
+
+    uint32_t& bucketOf(ShardHeader* shard, uint64_t hash) const
+    {
+        // 分片已用掉低位的取模结果，桶号取乘法散列后的高位
+        uint64_t mixed = hash * 0x9E3779B97F4A7C15ULL;
+        return buckets(shard)[(mixed >> 32) & (header()->bucketsPerShard - 1)];
+    }
+
+    uint32_t find(ShardHeader* shard, uint64_t hash, std::string_view keyBytes) const
+    {
+        for (uint32_t index = bucketOf(shard, hash); index != kNil; index = slot(shard, index)->hashNext)
+        {
+            SlotHeader* s = slot(shard, index);
+            if (s->hash == hash && s->keyLen == keyBytes.size()
+                && std::memcmp(keyOf(shard, index), keyBytes.data(), keyBytes.size()) == 0)
+                return index;
+        }
+        return kNil;
+    }
+
+    // 需持有分片锁；条目放不进槽位时删除旧值，避免之后读到过期数据
+    void store(ShardHeader* shard, uint64_t hash, std::string_view keyBytes, std::string_view valueBytes)
+    {
+        const SegmentHeader* h = header();
+        uint32_t index = find(shard, hash, keyBytes);
+        if (keyBytes.size() > h->maxKeyBytes || valueBytes.size() > h->maxValueBytes)
+        {
+            if (index != kNil)
+                release(shard, index);
+            ++shard->rejected;
+            return;
+        }
+
+        if (index == kNil)
+        {
+            if (shard->freeHead == kNil)
+                release(shard, shard->tail);
+            index = shard->freeHead;
+            SlotHeader* s = slot(shard, index);
+            shard->freeHead = s->next;
+            s->hash = hash;
+            s->keyLen = keyBytes.size();
+            std::memcpy(keyOf(shard, index), keyBytes.data(), keyBytes.size());
+            uint32_t& bucket = bucketOf(shard, hash);
+            s->hashNext = bucket;
+            bucket = index;
+            pushHead(shard, index);
+            ++shard->size;
+        }
+        else
+        {
+            moveToHead(shard, index);
+        }
+
+        SlotHeader* s = slot(shard, index);
+        s->valueLen = valueBytes.size();
+        std::memcpy(keyOf(shard, index) + h->maxKeyBytes, valueBytes.data(), valueBytes.size());
+    }
+
+    // 从哈希链和 LRU 链表摘下槽位并放回空闲链
+    void release(ShardHeader* shard, uint32_t index)
+    {
+        SlotHeader* s = slot(shard, index);
+        uint32_t* link = &bucketOf(shard, s->hash);
+        while (*link != index)
+            link = &slot(shard, *link)->hashNext;
+        *link = s->hashNext;
+
+        unlink(shard, index);
+        s->next = shard->freeHead;
+        shard->freeHead = index;
+        --shard->size;
+    }
+
+    void unlink(ShardHeader* shard, uint32_t index)
+    {
+        SlotHeader* s = slot(shard, index);
+        if (s->prev != kNil)
+            slot(shard, s->prev)->next = s->next;
+        else
+            shard->head = s->next;
+        if (s->next != kNil)
+            slot(shard, s->next)->prev = s->prev;
+        else
+            shard->tail = s->prev;
+    }
+
+    void pushHead(ShardHeader* shard, uint32_t index)
+    {
+        SlotHeader* s = slot(shard, index);
+        s->prev = kNil;
+        s->next = shard->head;
+        if (shard->head != kNil)
+            slot(shard, shard->head)->prev = index;
+        else
+            shard->tail = index;
+        shard->head = index;
+    }
+
+    void moveToHead(ShardHeader* shard, uint32_t index)
+    {
+        if (shard->head == index)
+            return;
+        unlink(shard, index);
+        pushHead(shard, index);
+    }
+
+private:
+    char*  base_ = nullptr;
+    size_t mappedBytes_ = 0;
+};
+
+}
@@ -0,0 +1,406 @@
+#pragma once
+
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace MyCache
+{
+
+// memcached 风格的 slab 分配器：按 growthFactor 递增划分 size class，
+// 每个 class 从整页（默认 64KB，mmap 得到）切分固定大小的 chunk。
+// 页内 chunk 全部释放后页面退回空闲池，可被任意 class 重新领用，超出保留数量的空页直接 munmap，
+// 这样各 class 之间的页面会随负载再平衡，RSS 也跟随实际数据量回落。
+// 超过 maxPayload() 的值单独 mmap 一块大 chunk，占用一个页面编号，释放时直接 munmap。
+class SlabAllocator
+{
+public:
+    using Handle = uint64_t;
+    static constexpr Handle kNullHandle = ~0ULL;
+
+    struct Stats
+    {
+        size_t pages = 0;
+        size_t sparePages = 0;
+        size_t mappedBytes = 0;
+        size_t chunkBytes = 0;
+        size_t payloadBytes = 0;
+        size_t largeChunks = 0;
+    };
+
+    explicit SlabAllocator(size_t pageSize = 64 << 10, size_t minChunk = 64,
+                           double growthFactor = 1.25, size_t maxSparePages = 2)
+        : pageSize_(pageSize)
+        , maxSparePages_(maxSparePages)
+    {
+        size_t chunk = alignUp(std::max(minChunk, sizeof(ChunkHeader) + 8));
+        while (chunk < pageSize_ / 2)
+        {
+            classes_.push_back(SlabClass{chunk, static_cast<uint32_t>(pageSize_ / chunk), {}});
+            chunk = alignUp(std::max(chunk + 8, static_cast<size_t>(chunk * growthFactor)));
+        }
+        classes_.push_back(SlabClass{pageSize_, 1, {}});
+    }
+
+    ~SlabAllocator()
+    {
+        for (auto& page : pages_)
+        {
+            if (page.mem)
+                ::munmap(page.mem, mappedSize(page));
+        }
+    }
+
+    SlabAllocator(const SlabAllocator&) = delete;
+    SlabAllocator& operator=(const SlabAllocator&) = delete;
+
+    size_t maxPayload() const { return pageSize_ - sizeof(ChunkHeader); }
+
+    // 分配一个能容纳 size 字节的 chunk，引用计数初始化为 1；映射失败时返回 kNullHandle
+    Handle allocate(size_t size, char** chunk)
+    {
+        if (size > maxPayload())
+            return allocateLarge(size, chunk);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t classId = classFor(size + sizeof(ChunkHeader));
+        SlabClass& slabClass = classes_[classId];
+        if (slabClass.partialPages.empty())
+        {
+            uint32_t pageId = takePage(classId);
+            if (pageId == kNoPage)
+                return kNullHandle;
+            addPartial(slabClass, pageId);
+        }
+
+        uint32_t pageId = slabClass.partialPages.back();
+        Page& page = pages_[pageId];
+        uint32_t index;
+        if (page.freeHead != kNoChunk)
+        {
+            index = page.freeHead;
+            std::memcpy(&page.freeHead, chunkAt(page, index), sizeof(uint32_t));
+        }
+        else
+        {
+            index = page.carved++;
+        }
+        if (++page.used == slabClass.perPage)
+            removePartial(slabClass, pageId);
+
+        char* mem = chunkAt(page, index);
+        new (mem) ChunkHeader{{1}, static_cast<uint32_t>(size)};
+        payloadBytes_ += size;
+        *chunk = mem;
+        return (static_cast<Handle>(pageId) << 32) | index;
+    }
+
+    void deallocate(Handle handle)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        uint32_t pageId = static_cast<uint32_t>(handle >> 32);
+        uint32_t index = static_cast<uint32_t>(handle);
+        Page& page = pages_[pageId];
+        if (page.classId == kLargeClass)
+        {
+            payloadBytes_ -= reinterpret_cast<ChunkHeader*>(page.mem)->length;
+            ::munmap(page.mem, page.largeBytes);
+            page.mem = nullptr;
+            page.classId = kNoClass;
+            unmappedPages_.push_back(pageId);
+            return;
+        }
+        SlabClass& slabClass = classes_[page.classId];
+
+        char* mem = chunkAt(page, index);
+        ChunkHeader* header = reinterpret_cast<ChunkHeader*>(mem);
+        payloadBytes_ -= header->length;
+        header->~ChunkHeader();
+
+        std::memcpy(mem, &page.freeHead, sizeof(uint32_t));
+        page.freeHead = index;
+        if (page.used-- == slabClass.perPage)
+            addPartial(slabClass, pageId);
+
+        if (page.used == 0)
+        {
+            removePartial(slabClass, pageId);
+            releasePage(pageId);
+        }
+    }
+
+    static std::atomic<uint32_t>& refCount(char* chunk)
+    {
+        return reinterpret_cast<ChunkHeader*>(chunk)->refs;
+    }
+
+    static std::string_view view(const char* chunk)
+    {
+        const ChunkHeader* header = reinterpret_cast<const ChunkHeader*>(chunk);
+        return std::string_view(chunk + sizeof(ChunkHeader), header->length);
+    }
+
+    static char* payload(char* chunk) { return chunk + sizeof(ChunkHeader); }
+
+    Stats stats()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Stats stats;
+        for (const auto& page : pages_)
+        {
+            if (!page.mem)
+                continue;
+            stats.mappedBytes += mappedSize(page);
+            if (page.classId == kLargeClass)
+            {
+                ++stats.largeChunks;
+                stats.chunkBytes += page.largeBytes;
+                continue;
+            }
+            if (page.classId == kNoClass)
+            {
+                ++stats.sparePages;
+                continue;
+            }
+            ++stats.pages;
+            stats.chunkBytes += static_cast<size_t>(page.used) * classes_[page.classId].chunkSize;
+        }
+        stats.payloadBytes = payloadBytes_;
+        return stats;
+    }
+
+private:
+    static constexpr uint32_t kNoPage = ~0U;
+    static constexpr uint32_t kNoChunk = ~0U;
+    static constexpr uint32_t kNoClass = ~0U;
+    static constexpr uint32_t kLargeClass = ~0U - 1;
+    static constexpr size_t   kMapAlign = 4096;
+
+    struct ChunkHeader
+    {
+        std::atomic<uint32_t> refs;
+        uint32_t              length;
+    };
+
+    struct Page
+    {
+        char*    mem;
+        uint32_t classId;
+        uint32_t used;
+        uint32_t carved;
+        uint32_t freeHead;
+        size_t   partialPos;
+        size_t   largeBytes;
+    };
+
+    struct SlabClass
+    {
+        size_t                chunkSize;
+        uint32_t              perPage;
+        std::vector<uint32_t> partialPages;
+    };
+
+    static size_t alignUp(size_t size) { return (size + 7) & ~static_cast<size_t>(7); }
+
+    size_t classFor(size_t size) const
+    {
+        auto it = std::lower_bound(classes_.begin(), classes_.end(), size,
+                                   [](const SlabClass& c, size_t s) { return c.chunkSize < s; });
+        return it - classes_.begin();
+    }
+
+    char* chunkAt(Page& page, uint32_t index)
+    {
+        return page.mem + static_cast<size_t>(index) * classes_[page.classId].chunkSize;
+    }
+
+    size_t mappedSize(const Page& page) const
+    {
+        return page.classId == kLargeClass ? page.largeBytes : pageSize_;
+    }
+
+    // 大 chunk 单独映射，长度按 kMapAlign 取整；长度超出 ChunkHeader 的表示范围时返回 kNullHandle
+    Handle allocateLarge(size_t size, char** chunk)
+    {
+        if (size > UINT32_MAX)
+            return kNullHandle;
+        size_t bytes = (size + sizeof(ChunkHeader) + kMapAlign - 1) & ~(kMapAlign - 1);
+        void* mem = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mem == MAP_FAILED)
+            return kNullHandle;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        uint32_t pageId;
+        if (!unmappedPages_.empty())
+        {
+            pageId = unmappedPages_.back();
+            unmappedPages_.pop_back();
+        }
+        else
+        {
+            pageId = static_cast<uint32_t>(pages_.size());
+            pages_.push_back(Page{});
+        }
+        Page& page = pages_[pageId];
+        page.mem = static_cast<char*>(mem);
+        page.classId = kLargeClass;
+        page.used = 1;
+        page.largeBytes = bytes;
+
+        new (page.mem) ChunkHeader{{1}, static_cast<uint32_t>(size)};
+        payloadBytes_ += size;
+        *chunk = page.mem;
+        return static_cast<Handle>(pageId) << 32;
+    }
+
+    uint32_t takePage(size_t classId)
+    {
+        uint32_t pageId;
+        if (!sparePages_.empty())
+        {
+            pageId = sparePages_.back();
+            sparePages_.pop_back();
+        }
+        else
+        {
+            void* mem = ::mmap(nullptr, pageSize_, PROT_READ | PROT_WRITE,
+                               MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (mem == MAP_FAILED)
+                return kNoPage;
+            if (!unmappedPages_.empty())
+            {
+                pageId = unmappedPages_.back();
+                unmappedPages_.pop_back();
+            }
+            else
+            {
+                pageId = static_cast<uint32_t>(pages_.size());
+                pages_.push_back(Page{});
+            }
+            pages_[pageId].mem = static_cast<char*>(mem);
+        }
+
+        Page& page = pages_[pageId];
+        page.classId = static_cast<uint32_t>(classId);
+        page.used = 0;
+        page.carved = 0;
+        page.freeHead = kNoChunk;
+        return pageId;
+    }
+
+    void releasePage(uint32_t pageId)
+    {
+        Page& page = pages_[pageId];
+        page.classId = kNoClass;
+        if (sparePages_.size() < maxSparePages_)
+        {
+            sparePages_.push_back(pageId);
+            return;
+        }
+        ::munmap(page.mem, pageSize_);
+        page.mem = nullptr;
+        unmappedPages_.push_back(pageId);
+    }
+
+    void addPartial(SlabClass& slabClass, uint32_t pageId)
+    {
+        pages_[pageId].partialPos = slabClass.partialPages.size();
+        slabClass.partialPages.push_back(pageId);
+    }
+
+    void removePartial(SlabClass& slabClass, uint32_t pageId)
+    {
+        size_t pos = pages_[pageId].partialPos;
+        uint32_t last = slabClass.partialPages.back();
+        slabClass.partialPages[pos] = last;
+        pages_[last].partialPos = pos;
+        slabClass.partialPages.pop_back();
+    }
+
+private:
+    size_t                 pageSize_;
+    size_t                 maxSparePages_;
+    size_t                 payloadBytes_ = 0;
+    std::mutex             mutex_;
+    std::vector<SlabClass> classes_;
+    std::vector<Page>      pages_;
+    std::vector<uint32_t>  sparePages_;
+    std::vector<uint32_t>  unmappedPages_;
+};
+
+// 指向 slab chunk 的引用计数句柄，可直接作为 LruBase/LfuBase 等策略的 Value 使用：
+// 策略内部照常拷贝值，最后一个句柄析构时 chunk 归还给所属分配器。
+class SlabValue
+{
+public:
+    SlabValue() : store_(nullptr), handle_(SlabAllocator::kNullHandle), chunk_(nullptr) {}
+
+    // 只有内存映射失败时抛出 std::bad_alloc，超过一页的值走大 chunk
+    SlabValue(SlabAllocator& store, std::string_view data)
+        : store_(&store)
+        , chunk_(nullptr)
+    {
+        handle_ = store.allocate(data.size(), &chunk_);
+        if (handle_ == SlabAllocator::kNullHandle)
+            throw std::bad_alloc();
+        std::memcpy(SlabAllocator::payload(chunk_), data.data(), data.size());
+    }
+
+    SlabValue(const SlabValue& other)
+        : store_(other.store_)
+        , handle_(other.handle_)
+        , chunk_(other.chunk_)
+    {
+        if (chunk_)
+            SlabAllocator::refCount(chunk_).fetch_add(1, std::memory_order_relaxed);
+    }
+
+    SlabValue(SlabValue&& other) noexcept
+        : store_(other.store_)
+        , handle_(other.handle_)
+        , chunk_(other.chunk_)
+    {
+        other.chunk_ = nullptr;
+    }
+
+    SlabValue& operator=(SlabValue other) noexcept
+    {
+        std::swap(store_, other.store_);
+        std::swap(handle_, other.handle_);
+        std::swap(chunk_, other.chunk_);
+        return *this;
+    }
+
+    ~SlabValue()
+    {
+        if (chunk_ && SlabAllocator::refCount(chunk_).fetch_sub(1, std::memory_order_acq_rel) == 1)
+            store_->deallocate(handle_);
+    }
+
+    std::string_view view() const
+    {
+        return chunk_ ? SlabAllocator::view(chunk_) : std::string_view();
+    }
+
+    std::string str() const { return std::string(view()); }
+    size_t size() const { return view().size(); }
+    bool empty() const { return view().empty(); }
+
+    bool operator==(const SlabValue& other) const { return view() == other.view(); }
+    bool operator!=(const SlabValue& other) const { return !(*this == other); }
+
+private:
+    SlabAllocator*        store_;
+    SlabAllocator::Handle handle_;
+    char*                 chunk_;
+};
+
+}
@@ -0,0 +1,191 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "CacheOps.h"
+#include "HashCaches.h"
+#include "LruBase.h"
+#include "MemoryUsage.h"
+
+namespace MyCache
+{
+
+// 按标签批量失效的分片缓存：put 时给条目附上若干标签，invalidateTag(tag) 让带该标签的所有条目失效。
+// 失效是惰性的：标签散列到一张全局的代数表，条目记下 put 时各标签所在槽位的代数；
+// invalidateTag 只把槽位代数加一（一次原子操作，不加任何分片锁），之后读到代数不符的条目时当作未命中并删除。
+// 槽位数固定，内存不随标签数增长；不同标签落到同一槽位时会连带失效，只多出未命中，不会读到过期数据。
+// 失效的条目在被访问或按容量淘汰之前仍占用容量。
+template<typename Key, typename Value, typename Tag = std::string,
+         template<typename, typename> class Policy = LruBase>
+class HashTaggedCaches : public CacheOps<HashTaggedCaches<Key, Value, Tag, Policy>, Key, Value>
+{
+public:
+    struct Stats
+    {
+        uint64_t invalidations = 0;
+        uint64_t staleDrops = 0;
+    };
+
+    template<typename... Args>
+    HashTaggedCaches(size_t capacity, int sliceNum, size_t tagSlots = 1 << 16, Args... args)
+        : caches_(capacity, sliceNum, args...)
+    {
+        size_t slots = 1;
+        while (slots < tagSlots)
+            slots <<= 1;
+        generations_ = std::make_unique<std::atomic<uint64_t>[]>(slots);
+        mask_ = slots - 1;
+    }
+
+    void put(Key key, Value value)
+    {
+        caches_.put(key, TaggedValue{std::move(value), {}});
+    }
+
+    void put(Key key, Value value, const std::vector<Tag>& tags)
+    {
+        caches_.put(key, TaggedValue{std::move(value), stampsOf(tags)});
+    }
+
+    bool get(Key key, Value& value)
+    {
+        bool hit = false;
+        caches_.mutate(key, [&](TaggedValue* current) {
+            if (!current)
+                return Mutation<TaggedValue>::keep();
+            if (!fresh(*current))
+            {
+                ++staleDrops_;
+                return Mutation<TaggedValue>::remove();
+            }
+            value = current->value;
+            hit = true;
+            return Mutation<TaggedValue>::keep();
+        });
+        return hit;
+    }
+
+    Value get(Key key)
+    {
+        Value value{};
+        get(key, value);
+        return value;
+    }
+
+    // 未命中时调用 loader(key) -> Value 并带标签写入。标签代数在调用 loader 之前读取，
+    // 加载期间若有标签被失效，写入的条目随即视为过期，不会把失效前读到的数据留在缓存里
+    template<typename Loader>
+    Value getOrLoad(const Key& key, const std::vector<Tag>& tags, Loader loader)
+    {
+        Value value;
+        if (get(key, value))
+            return value;
+        std::vector<TagStamp> stamps = stampsOf(tags);
+        value = loader(key);
+        caches_.put(key, TaggedValue{value, std::move(stamps)});
+        return value;
+    }
+
+    void remove(Key key)
+    {
+        caches_.remove(key);
+    }
+
+    // 已失效的条目按不存在处理；Set 写入时沿用原条目仍然有效的标签
+    template<typename Fn>
+    void mutate(const Key& key, Fn fn)
+    {
+        caches_.mutate(key, [&](TaggedValue* current) {
+            bool stale = current && !fresh(*current);
+            if (stale)
+            {
+                ++staleDrops_;
+                current = nullptr;
+            }
+            Mutation<Value> mutation = fn(current ? &current->value : nullptr);
+            if (mutation.kind == Mutation<Value>::Kind::Set)
+                return Mutation<TaggedValue>::set(
+                    TaggedValue{std::move(mutation.value), current ? current->stamps : std::vector<TagStamp>()});
+            if (mutation.kind == Mutation<Value>::Kind::Remove || stale)
+                return Mutation<TaggedValue>::remove();
+            return Mutation<TaggedValue>::keep();
+        });
+    }
+
+    // 让所有带 tag 的条目失效，对所有分片立即生效
+    void invalidateTag(const Tag& tag)
+    {
+        generations_[slotOf(tag)].fetch_add(1, std::memory_order_acq_rel);
+        ++invalidations_;
+    }
+
+    Stats stats() const
+    {
+        return Stats{invalidations_, staleDrops_};
+    }
+
+    // 各分片的内存占用（含条目上的标签代数），见 MemoryUsage.h；全局代数表另见 tagTableBytes
+    std::vector<MemoryUsage> memoryUsage() { return caches_.memoryUsage(); }
+
+    size_t tagTableBytes() const { return (mask_ + 1) * sizeof(std::atomic<uint64_t>); }
+
+private:
+    struct TagStamp
+    {
+        uint32_t slot;
+        uint64_t generation;
+    };
+
+    struct TaggedValue
+    {
+        Value                 value;
+        std::vector<TagStamp> stamps;
+
+        friend size_t heapBytes(const TaggedValue& tagged)
+        {
+            return heapBytes(tagged.value) + tagged.stamps.capacity() * sizeof(TagStamp);
+        }
+    };
+
+    size_t slotOf(const Tag& tag) const
+    {
+        return (std::hash<Tag>()(tag) * 0x9E3779B97F4A7C15ULL >> 32) & mask_;
+    }
+
+    std::vector<TagStamp> stampsOf(const std::vector<Tag>& tags) const
+    {
+        std::vector<TagStamp> stamps;
+        stamps.reserve(tags.size());
+        for (const Tag& tag : tags)
+        {
+            size_t slot = slotOf(tag);
+            stamps.push_back(TagStamp{static_cast<uint32_t>(slot), generations_[slot].load(std::memory_order_acquire)});
+        }
+        return stamps;
+    }
+
+    bool fresh(const TaggedValue& tagged) const
+    {
+        for (const TagStamp& stamp : tagged.stamps)
+        {
+            if (generations_[stamp.slot].load(std::memory_order_acquire) != stamp.generation)
+                return false;
+        }
+        return true;
+    }
+
+private:
+    HashCaches<Key, TaggedValue, Policy<Key, TaggedValue>> caches_;
+    std::unique_ptr<std::atomic<uint64_t>[]>               generations_;
+    size_t                                                 mask_ = 0;
+    std::atomic<uint64_t>                                  invalidations_{0};
+    std::atomic<uint64_t>                                  staleDrops_{0};
+};
+
+}
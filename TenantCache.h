@@ -0,0 +1,278 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace MyCache
+{
+
+// 多租户共享的分片 LRU：所有租户共用一个总容量，每个租户有最低保障 minEntries 与上限 maxEntries（0 表示不设上限），
+// 两者按分片数均分到每个分片。分片内每个租户各有一条 LRU 链表。
+// 插入时租户已到上限则淘汰自己最久未用的条目；分片满时从超出保障的租户中挑选受益最小者，
+// 即近期命中数 / 条目数最低的租户（近期命中数定期减半），淘汰它最久未用的条目。
+// 租户用 addTenant 返回的连续编号标识，查找时租户编号只与 key 的哈希做一次混合，租户状态按下标直接访问。
+template<typename Key, typename Value>
+class HashTenantCaches
+{
+public:
+    using TenantId = uint32_t;
+
+    struct TenantStats
+    {
+        size_t   entries = 0;
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+    };
+
+    HashTenantCaches(size_t capacity, int sliceNum)
+        : sliceNum_(sliceNum > 0 ? sliceNum : std::max(1u, std::thread::hardware_concurrency()))
+        , sliceSize_(std::ceil(capacity / static_cast<double>(sliceNum_)))
+    {
+        for (int i = 0; i < sliceNum_; ++i)
+        {
+            shards_.emplace_back(new Shard());
+        }
+    }
+
+    TenantId addTenant(size_t minEntries, size_t maxEntries = 0)
+    {
+        size_t shardMin = minEntries / sliceNum_;
+        size_t shardMax = maxEntries ? std::ceil(maxEntries / static_cast<double>(sliceNum_)) : sliceSize_;
+        shardMax = std::clamp<size_t>(shardMax, 1, sliceSize_);
+
+        std::lock_guard<std::mutex> registry(registryMutex_);
+        TenantId id = static_cast<TenantId>(tenantCount_++);
+        for (auto& shard : shards_)
+        {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            shard->tenants.emplace_back(id, std::min(shardMin, shardMax), shardMax);
+        }
+        return id;
+    }
+
+    void put(TenantId tenant, Key key, Value value)
+    {
+        size_t hash = hashOf(tenant, key);
+        Shard& shard = *shards_[hash % sliceNum_];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        Tenant& state = tenantOf(shard, tenant);
+        auto it = shard.index.find(EntryKey{tenant, key});
+        if (it != shard.index.end())
+        {
+            it->second->value = value;
+            state.lru.splice(state.lru.begin(), state.lru, it->second);
+            return;
+        }
+
+        if (!makeRoom(shard, state))
+            return;
+        state.lru.push_front(Entry{key, value});
+        shard.index.emplace(EntryKey{tenant, key}, state.lru.begin());
+        ++shard.size;
+    }
+
+    bool get(TenantId tenant, Key key, Value& value)
+    {
+        size_t hash = hashOf(tenant, key);
+        Shard& shard = *shards_[hash % sliceNum_];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        Tenant& state = tenantOf(shard, tenant);
+        if (++shard.accesses % kDecayInterval == 0)
+            decay(shard);
+
+        auto it = shard.index.find(EntryKey{tenant, key});
+        if (it == shard.index.end())
+        {
+            ++state.misses;
+            return false;
+        }
+        state.lru.splice(state.lru.begin(), state.lru, it->second);
+        value = it->second->value;
+        ++state.hits;
+        ++state.recentHits;
+        return true;
+    }
+
+    Value get(TenantId tenant, Key key)
+    {
+        Value value{};
+        get(tenant, key, value);
+        return value;
+    }
+
+    void remove(TenantId tenant, Key key)
+    {
+        size_t hash = hashOf(tenant, key);
+        Shard& shard = *shards_[hash % sliceNum_];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        Tenant& state = tenantOf(shard, tenant);
+        auto it = shard.index.find(EntryKey{tenant, key});
+        if (it == shard.index.end())
+            return;
+        state.lru.erase(it->second);
+        shard.index.erase(it);
+        --shard.size;
+    }
+
+    TenantStats stats(TenantId tenant)
+    {
+        TenantStats total;
+        for (auto& shard : shards_)
+        {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            const Tenant& state = tenantOf(*shard, tenant);
+            total.entries += state.lru.size();
+            total.hits += state.hits;
+            total.misses += state.misses;
+            total.evictions += state.evictions;
+        }
+        return total;
+    }
+
+    size_t tenantCount()
+    {
+        std::lock_guard<std::mutex> registry(registryMutex_);
+        return tenantCount_;
+    }
+
+private:
+    static constexpr uint64_t kDecayInterval = 1 << 14;
+
+    struct EntryKey
+    {
+        TenantId tenant;
+        Key      key;
+
+        bool operator==(const EntryKey& other) const { return tenant == other.tenant && key == other.key; }
+    };
+
+    struct EntryKeyHash
+    {
+        size_t operator()(const EntryKey& entry) const { return hashOf(entry.tenant, entry.key); }
+    };
+
+    struct Entry
+    {
+        Key   key;
+        Value value;
+    };
+
+    using EntryList = std::list<Entry>;
+
+    struct Tenant
+    {
+        Tenant(TenantId id, size_t minEntries, size_t maxEntries)
+            : id(id)
+            , minEntries(minEntries)
+            , maxEntries(maxEntries)
+        {}
+
+        TenantId  id;
+        size_t    minEntries;
+        size_t    maxEntries;
+        EntryList lru;
+        uint64_t  hits = 0;
+        uint64_t  misses = 0;
+        uint64_t  evictions = 0;
+        uint64_t  recentHits = 0;
+    };
+
+    struct Shard
+    {
+        std::mutex                                                               mutex;
+        // index 中保存指向各租户链表的迭代器，deque 追加租户时已有元素不移动
+        std::deque<Tenant>                                                       tenants;
+        std::unordered_map<EntryKey, typename EntryList::iterator, EntryKeyHash> index;
+        size_t                                                                   size = 0;
+        uint64_t                                                                 accesses = 0;
+    };
+
+    // 只对 key 做一次哈希，租户编号用乘法混合进去
+    static size_t hashOf(TenantId tenant, const Key& key)
+    {
+        return std::hash<Key>()(key) ^ ((tenant + 1) * 0x9E3779B97F4A7C15ULL);
+    }
+
+    static Tenant& tenantOf(Shard& shard, TenantId tenant)
+    {
+        if (tenant >= shard.tenants.size())
+            throw std::out_of_range("unknown tenant");
+        return shard.tenants[tenant];
+    }
+
+    // 需持有分片锁；返回 false 表示无处可腾（分片已被各租户的保障额度占满且本租户没有条目）
+    bool makeRoom(Shard& shard, Tenant& requester)
+    {
+        if (requester.lru.size() >= requester.maxEntries)
+        {
+            evictFrom(shard, requester);
+            return true;
+        }
+        if (shard.size < sliceSize_)
+            return true;
+
+        Tenant* victim = nullptr;
+        for (Tenant& candidate : shard.tenants)
+        {
+            if (candidate.lru.size() <= candidate.minEntries)
+                continue;
+            if (!victim || lessBenefit(candidate, *victim))
+                victim = &candidate;
+        }
+        if (!victim)
+        {
+            if (requester.lru.empty())
+                return false;
+            victim = &requester;
+        }
+        evictFrom(shard, *victim);
+        return true;
+    }
+
+    // 命中密度低者受益小；比较 a.recentHits / a.size 与 b.recentHits / b.size，相同时先淘汰超出保障更多的
+    static bool lessBenefit(const Tenant& a, const Tenant& b)
+    {
+        uint64_t lhs = a.recentHits * b.lru.size();
+        uint64_t rhs = b.recentHits * a.lru.size();
+        if (lhs != rhs)
+            return lhs < rhs;
+        return a.lru.size() - a.minEntries > b.lru.size() - b.minEntries;
+    }
+
+    void evictFrom(Shard& shard, Tenant& tenant)
+    {
+        shard.index.erase(EntryKey{tenant.id, tenant.lru.back().key});
+        tenant.lru.pop_back();
+        ++tenant.evictions;
+        --shard.size;
+    }
+
+    static void decay(Shard& shard)
+    {
+        for (Tenant& tenant : shard.tenants)
+        {
+            tenant.recentHits /= 2;
+        }
+    }
+
+private:
+    int                                 sliceNum_;
+    size_t                              sliceSize_;
+    std::mutex                          registryMutex_;
+    size_t                              tenantCount_ = 0;
+    std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+}
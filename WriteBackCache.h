@@ -0,0 +1,314 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "HashCaches.h"
+#include "LruBase.h"
+
+namespace MyCache
+{
+
+// 回写模式：put 只写缓存并把条目记为脏，后台线程把各分片的脏条目批量交给 writer 写入下游存储。
+// 同一 key 落盘前的多次写入合并为最后一次；脏条目独立于缓存保存，被淘汰后仍会落盘，落盘前 get 也能读到。
+// remove 在脏表中记一个删除标记（值为空），落盘前 get 读不到，并随批次交给 writer 删除下游数据。
+// writer 返回 false 时该批条目重新并回脏表（期间被再次写入或删除的 key 以新操作为准），下一轮重试。
+template<typename Key, typename Value, typename CacheType = LruBase<Key, Value>>
+class HashWriteBackCaches
+{
+public:
+    // 值为空表示删除
+    using Batch = std::vector<std::pair<Key, std::optional<Value>>>;
+    using BatchWriter = std::function<bool(const Batch&)>;
+    // 析构时超过期限仍未写出的条目
+    using DropHandler = std::function<void(const Batch&)>;
+
+    struct Stats
+    {
+        uint64_t puts = 0;
+        uint64_t removes = 0;
+        uint64_t coalesced = 0;
+        uint64_t flushedEntries = 0;
+        uint64_t batches = 0;
+        uint64_t failedBatches = 0;
+        size_t   dirtyEntries = 0;
+    };
+
+    template<typename... Args>
+    HashWriteBackCaches(size_t capacity, int sliceNum, BatchWriter writer, size_t batchSize = 128,
+                        std::chrono::milliseconds flushInterval = std::chrono::milliseconds(50), Args... args)
+        : caches_(capacity, sliceNum, args...)
+        , writer_(std::move(writer))
+        , batchSize_(batchSize > 0 ? batchSize : 1)
+        , flushInterval_(flushInterval)
+        , shutdownDeadline_(std::chrono::seconds(1))
+        , dirtyShards_(caches_.sliceNum())
+        , stop_(false)
+        , flushRequests_(0)
+        , flushedRounds_(0)
+    {
+        flusher_ = std::thread([this]() { flusherLoop(); });
+    }
+
+    // 析构时把剩余脏条目交给 writer，失败则退避重试直到 shutdownDeadline_；
+    // 到期仍未写出的条目交给 onDrop_，未设置时直接丢弃
+    ~HashWriteBackCaches()
+    {
+        {
+            std::lock_guard<std::mutex> lock(flushMutex_);
+            stop_ = true;
+        }
+        flushCv_.notify_all();
+        flusher_.join();
+
+        auto deadline = std::chrono::steady_clock::now() + shutdownDeadline_;
+        auto backoff = std::chrono::milliseconds(1);
+        while (true)
+        {
+            flushAll();
+            if (dirtyCount() == 0)
+                return;
+            auto now = std::chrono::steady_clock::now();
+            if (now >= deadline)
+                break;
+            std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(backoff, deadline - now));
+            backoff = std::min(backoff * 2, std::chrono::milliseconds(100));
+        }
+
+        if (!onDrop_)
+            return;
+        Batch dropped;
+        for (auto& shard : dirtyShards_)
+        {
+            for (auto& entry : shard.dirty)
+            {
+                dropped.emplace_back(entry.first, std::move(entry.second));
+            }
+        }
+        onDrop_(dropped);
+    }
+
+    // 需在有其他线程访问缓存之前调用
+    void setShutdownPolicy(std::chrono::milliseconds deadline, DropHandler onDrop)
+    {
+        shutdownDeadline_ = deadline;
+        onDrop_ = std::move(onDrop);
+    }
+
+    HashWriteBackCaches(const HashWriteBackCaches&) = delete;
+    HashWriteBackCaches& operator=(const HashWriteBackCaches&) = delete;
+
+    // 缓存写入与脏表更新在同一把脏表锁内完成，避免 get 回填旧值覆盖新写入
+    void put(Key key, Value value)
+    {
+        size_t dirtyCount;
+        {
+            DirtyShard& shard = dirtyShards_[caches_.sliceIndex(key)];
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            caches_.put(key, value);
+            auto result = shard.dirty.insert_or_assign(std::move(key), std::optional<Value>(std::move(value)));
+            if (!result.second)
+                ++coalesced_;
+            dirtyCount = shard.dirty.size();
+        }
+        ++puts_;
+        if (dirtyCount >= batchSize_)
+            flushCv_.notify_one();
+    }
+
+    bool get(Key key, Value& value)
+    {
+        if (caches_.get(key, value))
+            return true;
+
+        // 已被淘汰但尚未落盘的条目；脏表中的删除标记比在途批次更新
+        DirtyShard& shard = dirtyShards_[caches_.sliceIndex(key)];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.dirty.find(key);
+        if (it == shard.dirty.end() && (it = shard.inflight.find(key)) == shard.inflight.end())
+            return false;
+        if (!it->second)
+            return false;
+        value = *it->second;
+        caches_.put(key, value);
+        return true;
+    }
+
+    Value get(Key key)
+    {
+        Value value{};
+        get(key, value);
+        return value;
+    }
+
+    // 删除缓存中的副本并在脏表中记删除标记，覆盖尚未落盘的写入，落盘时通知 writer 删除
+    void remove(Key key)
+    {
+        size_t dirtyCount;
+        {
+            DirtyShard& shard = dirtyShards_[caches_.sliceIndex(key)];
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            caches_.remove(key);
+            auto result = shard.dirty.insert_or_assign(std::move(key), std::nullopt);
+            if (!result.second)
+                ++coalesced_;
+            dirtyCount = shard.dirty.size();
+        }
+        ++removes_;
+        if (dirtyCount >= batchSize_)
+            flushCv_.notify_one();
+    }
+
+    // 阻塞直到调用前产生的脏条目都已交给 writer（失败的批次不会等待重试）
+    void flush()
+    {
+        std::unique_lock<std::mutex> lock(flushMutex_);
+        uint64_t target = ++flushRequests_;
+        flushCv_.notify_all();
+        flushedCv_.wait(lock, [this, target]() { return flushedRounds_ >= target || stop_; });
+    }
+
+    Stats stats()
+    {
+        Stats stats;
+        stats.puts = puts_;
+        stats.removes = removes_;
+        stats.coalesced = coalesced_;
+        stats.flushedEntries = flushedEntries_;
+        stats.batches = batches_;
+        stats.failedBatches = failedBatches_;
+        stats.dirtyEntries = dirtyCount();
+        return stats;
+    }
+
+private:
+    struct DirtyShard
+    {
+        std::mutex                                    mutex;
+        std::unordered_map<Key, std::optional<Value>> dirty;
+        std::unordered_map<Key, std::optional<Value>> inflight;
+    };
+
+    void flusherLoop()
+    {
+        std::unique_lock<std::mutex> lock(flushMutex_);
+        while (!stop_)
+        {
+            flushCv_.wait_for(lock, flushInterval_);
+            if (stop_)
+                break;
+
+            uint64_t target = flushRequests_;
+            lock.unlock();
+            flushAll();
+            lock.lock();
+            flushedRounds_ = target;
+            flushedCv_.notify_all();
+        }
+        flushedCv_.notify_all();
+    }
+
+    size_t dirtyCount()
+    {
+        size_t count = 0;
+        for (auto& shard : dirtyShards_)
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            count += shard.dirty.size() + shard.inflight.size();
+        }
+        return count;
+    }
+
+    void flushAll()
+    {
+        for (auto& shard : dirtyShards_)
+        {
+            flushShard(shard);
+        }
+    }
+
+    // 只由后台线程（或析构时）调用，同一时刻每个分片最多一个批次在途
+    void flushShard(DirtyShard& shard)
+    {
+        Batch entries;
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            if (shard.dirty.empty())
+                return;
+            shard.inflight.swap(shard.dirty);
+            entries.reserve(shard.inflight.size());
+            for (const auto& entry : shard.inflight)
+            {
+                entries.emplace_back(entry.first, entry.second);
+            }
+        }
+
+        Batch batch;
+        batch.reserve(batchSize_);
+        Batch failed;
+        for (size_t begin = 0; begin < entries.size(); begin += batchSize_)
+        {
+            size_t end = std::min(entries.size(), begin + batchSize_);
+            batch.assign(std::make_move_iterator(entries.begin() + begin),
+                         std::make_move_iterator(entries.begin() + end));
+            ++batches_;
+            if (writer_(batch))
+            {
+                flushedEntries_ += batch.size();
+            }
+            else
+            {
+                ++failedBatches_;
+                for (auto& entry : batch)
+                {
+                    failed.push_back(std::move(entry));
+                }
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        for (auto& entry : failed)
+        {
+            // 写失败期间又有新写入或删除时以新操作为准
+            shard.dirty.try_emplace(std::move(entry.first), std::move(entry.second));
+        }
+        shard.inflight.clear();
+    }
+
+private:
+    HashCaches<Key, Value, CacheType> caches_;
+    BatchWriter                       writer_;
+    size_t                            batchSize_;
+    std::chrono::milliseconds         flushInterval_;
+    std::chrono::milliseconds         shutdownDeadline_;
+    DropHandler                       onDrop_;
+    std::vector<DirtyShard>           dirtyShards_;
+
+    std::mutex                        flushMutex_;
+    std::condition_variable           flushCv_;
+    std::condition_variable           flushedCv_;
+    bool                              stop_;
+    uint64_t                          flushRequests_;
+    uint64_t                          flushedRounds_;
+    std::thread                       flusher_;
+
+    std::atomic<uint64_t>             puts_{0};
+    std::atomic<uint64_t>             removes_{0};
+    std::atomic<uint64_t>             coalesced_{0};
+    std::atomic<uint64_t>             flushedEntries_{0};
+    std::atomic<uint64_t>             batches_{0};
+    std::atomic<uint64_t>             failedBatches_{0};
+};
+
+}
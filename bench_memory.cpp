@@ -0,0 +1,163 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "ArcCache.h"
+#include "HashCaches.h"
+#include "HashLfuCache.h"
+#include "HashLruCache.h"
+#include "SampledCache.h"
+
+// 各策略每个条目的内存开销：按容量装满分片缓存后读取 memoryUsage()，给出每条目的索引、元数据、数据字节数，
+// 同时用全局 operator new 统计进程堆的实际增量，核对计数分配器覆盖了多少（不含 malloc 自身的块头与对齐）。
+// ARC 写入两倍容量的 key 并各读一次，使 LRU、LFU 两部分和幽灵表都处于装满状态（两部分各可容纳 capacity 个条目）。
+// LRU(采样) 为采样淘汰的 SampledCache，条目数组按容量预留，名称与 test.cpp 一致。
+// 用法: bench_memory [maxCapacity] [sliceNum]
+
+namespace {
+
+size_t liveHeapBytes = 0;
+
+}
+
+void* operator new(size_t size) {
+    // 在块前记下大小，释放时扣回
+    void* block = std::malloc(size + 16);
+    if (!block) {
+        throw std::bad_alloc();
+    }
+    *static_cast<size_t*>(block) = size;
+    __atomic_add_fetch(&liveHeapBytes, size, __ATOMIC_RELAXED);
+    return static_cast<char*>(block) + 16;
+}
+
+void operator delete(void* p) noexcept {
+    if (!p) {
+        return;
+    }
+    void* block = static_cast<char*>(p) - 16;
+    __atomic_sub_fetch(&liveHeapBytes, *static_cast<size_t*>(block), __ATOMIC_RELAXED);
+    std::free(block);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    operator delete(p);
+}
+
+namespace {
+
+size_t heapNow() {
+    return __atomic_load_n(&liveHeapBytes, __ATOMIC_RELAXED);
+}
+
+constexpr size_t kNameWidth = 10;
+
+// 各组 key / value 类型：makeKey / makeValue 由序号生成，字符串长度固定
+struct IntInt {
+    static constexpr const char* name = "int -> int";
+    static int makeKey(size_t i) { return static_cast<int>(i); }
+    static int makeValue(size_t i) { return static_cast<int>(i); }
+};
+
+struct IntString {
+    static constexpr const char* name = "int64 -> string(32)";
+    static int64_t makeKey(size_t i) { return static_cast<int64_t>(i) * 2654435761LL; }
+    static std::string makeValue(size_t) { return std::string(32, 'v'); }
+};
+
+struct StringString {
+    static constexpr const char* name = "string(24) -> string(128)";
+    static std::string makeKey(size_t i) {
+        char buffer[32];
+        std::snprintf(buffer, sizeof(buffer), "user:%019zu", i);
+        return buffer;
+    }
+    static std::string makeValue(size_t) { return std::string(128, 'v'); }
+};
+
+// 策略名含中文，按终端显示宽度（UTF-8 三字节字符占两列）左对齐
+std::string padName(const std::string& name, size_t width) {
+    size_t columns = 0;
+    for (unsigned char c : name) {
+        if (c < 0x80) {
+            columns += 1;
+        } else if (c >= 0xE0) {
+            columns += 2;
+        }
+    }
+    return name + std::string(columns < width ? width - columns : 0, ' ');
+}
+
+void printRow(const std::string& policy, const char* types, size_t capacity, const MyCache::MemoryUsage& usage,
+              size_t heapDelta) {
+    double entries = usage.entries ? usage.entries : 1;
+    std::cout << std::left << padName(policy, kNameWidth) << std::setw(27) << types << std::right
+              << std::setw(10) << capacity << std::setw(10) << usage.entries << std::fixed << std::setprecision(1)
+              << std::setw(9) << usage.indexBytes / entries
+              << std::setw(9) << usage.metadataBytes / entries
+              << std::setw(9) << usage.payloadBytes / entries
+              << std::setw(9) << usage.totalBytes() / entries
+              << std::setw(9) << heapDelta / entries
+              << std::setw(8) << (heapDelta ? 100.0 * usage.totalBytes() / heapDelta : 0) << "%" << std::endl;
+}
+
+// fill(cache, count) 写入 count 个条目；缓存在两次读取堆计数之间构造，堆增量只包含它自己
+template<typename Types, typename Cache, typename Fill>
+void measure(const std::string& policy, size_t capacity, int sliceNum, size_t count, Fill fill) {
+    size_t before = heapNow();
+    Cache cache(capacity, sliceNum);
+    fill(cache, count);
+    size_t heapDelta = heapNow() - before;
+    printRow(policy, Types::name, capacity, MyCache::totalOf(cache.memoryUsage()), heapDelta);
+}
+
+template<typename Types>
+void runTypes(size_t capacity, int sliceNum) {
+    using Key = decltype(Types::makeKey(0));
+    using Value = decltype(Types::makeValue(0));
+
+    auto fillPut = [](auto& cache, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            cache.put(Types::makeKey(i), Types::makeValue(i));
+        }
+    };
+    auto fillPutGet = [](auto& cache, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            Key key = Types::makeKey(i);
+            cache.put(key, Types::makeValue(i));
+            cache.get(key);
+        }
+    };
+
+    measure<Types, MyCache::HashLruCaches<Key, Value>>("LRU", capacity, sliceNum, capacity, fillPut);
+    measure<Types, MyCache::HashLfu<Key, Value>>("LFU", capacity, sliceNum, capacity, fillPut);
+    measure<Types, MyCache::HashCaches<Key, Value, MyCache::ArcCache<Key, Value>>>("ARC", capacity, sliceNum,
+                                                                                   capacity * 2, fillPutGet);
+    measure<Types, MyCache::HashCaches<Key, Value, MyCache::SampledCache<Key, Value>>>("LRU(采样)", capacity,
+                                                                                      sliceNum, capacity, fillPut);
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    size_t maxCapacity = argc > 1 ? std::stoull(argv[1]) : 10000000;
+    int sliceNum = argc > 2 ? std::stoi(argv[2]) : 8;
+
+    std::cout << "分片数: " << sliceNum << "，以下均为每条目字节数；heap 为进程堆增量，cover = 统计合计 / heap"
+              << std::endl;
+    std::cout << std::left << padName("", kNameWidth) << std::setw(27) << "types" << std::right
+              << std::setw(10) << "capacity" << std::setw(10) << "entries" << std::setw(9) << "index"
+              << std::setw(9) << "meta" << std::setw(9) << "payload" << std::setw(9) << "total"
+              << std::setw(9) << "heap" << std::setw(9) << "cover" << std::endl;
+    for (size_t capacity = 1000; capacity <= maxCapacity; capacity *= 10) {
+        runTypes<IntInt>(capacity, sliceNum);
+        runTypes<IntString>(capacity, sliceNum);
+        runTypes<StringString>(capacity, sliceNum);
+    }
+    return 0;
+}
@@ -1,38 +1,45 @@
 #pragma once
 
+#include <memory>
+
 #include "LruBase.h"
 
-namespace MyCache 
+namespace MyCache
 {
 
 template<typename Key, typename Value>
 class KLruCache : public LruBase<Key, Value> {
 public:
-    KLruCache(int capacity, int historyCapacity, int k) 
+    KLruCache(int capacity, int historyCapacity, int k)
     : LruBase<Key, Value> (capacity)
-    , historyList_(std::make_unique<LruBase<Key, size_t>> (historyCapacity))
     , k_(k)
+    , historyList_(std::make_unique<LruBase<Key, size_t>> (historyCapacity))
     {}
 
-    Value get(Key key) {
-        int historyCount = historyList_->get(key);
+    // 访问次数只在 put 中累计：读未命中后回填只算一次访问，get 不改动历史
+    // 已在缓存中的 key 直接更新；否则累计访问次数，达到 k 次才进入缓存
+    void put(Key key, Value value) override {
+        Value existing{};
+        if (LruBase<Key, Value>::get(key, existing)) {
+            LruBase<Key, Value>::put(key, value);
+            return;
+        }
+        size_t historyCount = historyList_->get(key);
         historyList_->put(key, ++historyCount);
-        return LruBase<Key, Value>::get(key);
-    }
-
-    void put(Key key, Value value) {
-        if (LruBase<Key, Value>::get(key) != "") LruBase<Key, Value>::put(key, Value);
-        int historyCount = historyList_->get(key);
-        historyList_->put(key, historyCount ++);
 
-        if (historyCount >= k_) {
+        if (historyCount >= static_cast<size_t>(k_)) {
             historyList_->remove(key);
             LruBase<Key, Value>::put(key, value);
         }
     }
 
+    // 只影响之后的准入，已缓存的条目与已累计的访问次数保留；须与 put 串行调用
+    void setK(int k) {
+        k_ = k;
+    }
+
 private:
     int                                   k_;
-    std::unique_ptr<LruBase<key, size_t>> historyList_;
+    std::unique_ptr<LruBase<Key, size_t>> historyList_;
 };
-}
\ No newline at end of file
+}
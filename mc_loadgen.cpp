@@ -0,0 +1,229 @@
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// mc_server 的回环压测工具：每个线程一条连接，按流水线深度批量发送 get/set，
+// 统计吞吐与每批请求的往返延迟。
+// 用法: mc_loadgen [port] [threads] [seconds] [keyRange] [valueSize] [getRatio] [pipeline]
+
+namespace {
+
+class Connection {
+public:
+    explicit Connection(uint16_t port) {
+        fd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (::connect(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+            throw std::runtime_error("cannot connect to port " + std::to_string(port));
+        }
+        int one = 1;
+        ::setsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    }
+
+    ~Connection() { ::close(fd_); }
+
+    void send(const std::string& data) {
+        size_t sent = 0;
+        while (sent < data.size()) {
+            ssize_t n = ::send(fd_, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+            if (n <= 0) {
+                throw std::runtime_error("send failed");
+            }
+            sent += n;
+        }
+    }
+
+    std::string readLine() {
+        while (true) {
+            size_t eol = buffer_.find("\r\n", pos_);
+            if (eol != std::string::npos) {
+                std::string line = buffer_.substr(pos_, eol - pos_);
+                pos_ = eol + 2;
+                return line;
+            }
+            fill();
+        }
+    }
+
+    void skip(size_t bytes) {
+        while (buffer_.size() - pos_ < bytes) {
+            fill();
+        }
+        pos_ += bytes;
+    }
+
+    // 读取一个 get 响应，返回命中的 key 数
+    int readGetResponse() {
+        int hits = 0;
+        while (true) {
+            std::string line = readLine();
+            if (line == "END") {
+                return hits;
+            }
+            if (line.compare(0, 6, "VALUE ") != 0) {
+                throw std::runtime_error("unexpected response: " + line);
+            }
+            // VALUE <key> <flags> <bytes> [cas]
+            size_t flagsEnd = line.find(' ', line.find(' ', 6) + 1);
+            size_t bytes = std::stoul(line.substr(flagsEnd + 1));
+            skip(bytes + 2);
+            hits++;
+        }
+    }
+
+private:
+    void fill() {
+        if (pos_ > 0 && pos_ == buffer_.size()) {
+            buffer_.clear();
+            pos_ = 0;
+        } else if (pos_ > (64 << 10)) {
+            buffer_.erase(0, pos_);
+            pos_ = 0;
+        }
+        char chunk[16 << 10];
+        ssize_t n = ::recv(fd_, chunk, sizeof(chunk), 0);
+        if (n <= 0) {
+            throw std::runtime_error("connection closed");
+        }
+        buffer_.append(chunk, n);
+    }
+
+    int fd_;
+    std::string buffer_;
+    size_t pos_ = 0;
+};
+
+struct WorkerResult {
+    long long gets = 0;
+    long long sets = 0;
+    long long hits = 0;
+    std::vector<double> latencies;    // 每批往返延迟，微秒
+};
+
+void runWorker(uint16_t port, int id, std::chrono::steady_clock::time_point deadline, int keyRange,
+               const std::string& value, double getRatio, int pipeline, WorkerResult& result) {
+    Connection conn(port);
+    std::mt19937 gen(id);
+    std::uniform_real_distribution<double> coin(0.0, 1.0);
+    std::string request;
+    std::vector<bool> isGet(pipeline);
+
+    while (std::chrono::steady_clock::now() < deadline) {
+        request.clear();
+        for (int i = 0; i < pipeline; ++i) {
+            // 偏斜分布：两次均匀采样取最小值，使小 key 更热
+            int key = std::min(gen() % keyRange, gen() % keyRange);
+            isGet[i] = coin(gen) < getRatio;
+            if (isGet[i]) {
+                request += "get key:" + std::to_string(key) + "\r\n";
+            } else {
+                request += "set key:" + std::to_string(key) + " 0 0 " + std::to_string(value.size()) + "\r\n";
+                request += value;
+                request += "\r\n";
+            }
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        conn.send(request);
+        for (int i = 0; i < pipeline; ++i) {
+            if (isGet[i]) {
+                result.hits += conn.readGetResponse();
+                result.gets++;
+            } else {
+                if (conn.readLine() != "STORED") {
+                    throw std::runtime_error("set failed");
+                }
+                result.sets++;
+            }
+        }
+        result.latencies.push_back(
+            std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+    }
+}
+
+double percentile(std::vector<double>& values, double p) {
+    if (values.empty()) {
+        return 0;
+    }
+    size_t index = std::min(values.size() - 1, static_cast<size_t>(p * values.size()));
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index];
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    uint16_t port = argc > 1 ? static_cast<uint16_t>(std::stoi(argv[1])) : 11211;
+    int threads = argc > 2 ? std::stoi(argv[2]) : 4;
+    int seconds = argc > 3 ? std::stoi(argv[3]) : 5;
+    int keyRange = argc > 4 ? std::stoi(argv[4]) : 100000;
+    size_t valueSize = argc > 5 ? std::stoul(argv[5]) : 100;
+    double getRatio = argc > 6 ? std::stod(argv[6]) : 0.9;
+    int pipeline = argc > 7 ? std::max(1, std::stoi(argv[7])) : 16;
+
+    std::string value(valueSize, 'v');
+
+    // 预热：先把一半 key 写进去
+    {
+        Connection conn(port);
+        std::string request;
+        for (int key = 0; key < keyRange / 2; ++key) {
+            request += "set key:" + std::to_string(key) + " 0 0 " + std::to_string(valueSize) + " noreply\r\n";
+            request += value + "\r\n";
+            if (request.size() > (256 << 10)) {
+                conn.send(request);
+                request.clear();
+            }
+        }
+        request += "version\r\n";
+        conn.send(request);
+        conn.readLine();
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(seconds);
+    std::vector<WorkerResult> results(threads);
+    std::vector<std::thread> workers;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < threads; ++i) {
+        workers.emplace_back(runWorker, port, i, deadline, keyRange, std::cref(value), getRatio, pipeline,
+                             std::ref(results[i]));
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    WorkerResult total;
+    for (auto& result : results) {
+        total.gets += result.gets;
+        total.sets += result.sets;
+        total.hits += result.hits;
+        total.latencies.insert(total.latencies.end(), result.latencies.begin(), result.latencies.end());
+    }
+
+    long long ops = total.gets + total.sets;
+    std::cout << "线程: " << threads << " 流水线深度: " << pipeline << " 值大小: " << valueSize << std::endl;
+    std::cout << "吞吐: " << std::fixed << std::setprecision(0) << ops / elapsed << " ops/s"
+              << " 命中率: " << std::setprecision(2) << (total.gets ? 100.0 * total.hits / total.gets : 0) << "%"
+              << std::endl;
+    std::cout << "批次延迟(us) p50: " << percentile(total.latencies, 0.50)
+              << " p99: " << percentile(total.latencies, 0.99)
+              << " p999: " << percentile(total.latencies, 0.999) << std::endl;
+    return 0;
+}
@@ -0,0 +1,29 @@
+#include <signal.h>
+
+#include <iostream>
+#include <string>
+
+#include "McServer.h"
+
+// 用法: mc_server [port] [capacity] [threads]
+int main(int argc, char* argv[]) {
+    uint16_t port = argc > 1 ? static_cast<uint16_t>(std::stoi(argv[1])) : 11211;
+    size_t capacity = argc > 2 ? std::stoul(argv[2]) : 1000000;
+    int threads = argc > 3 ? std::stoi(argv[3]) : 0;
+
+    // 事件循环线程不处理信号，由主线程等待 SIGINT/SIGTERM 后停止服务
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+    MyCache::McServer server(port, capacity, threads);
+    server.start();
+    std::cout << "mc_server 监听端口 " << server.port() << " 容量 " << capacity << std::endl;
+
+    int sig = 0;
+    sigwait(&signals, &sig);
+    server.stop();
+    return 0;
+}
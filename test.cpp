@@ -6,6 +6,21 @@
 #include <random>
 #include <array>
 #include <algorithm>
+#include <thread>
+#include <fstream>
+#include <filesystem>
+#include <atomic>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <coroutine>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <stdexcept>
+
+#include <sys/wait.h>
+#include <unistd.h>
 
 #include "CacheSer.h"
 #include "LfuBase.h"
@@ -14,6 +29,24 @@
 #include "ArcCache.h"
 #include "HashLfuCache.h"
 #include "HashLruCache.h"
+#include "EpochLruCache.h"
+#include "LirsCache.h"
+#include "S3FifoCache.h"
+#include "AdaptiveArcCache.h"
+#include "HashSlabCache.h"
+#include "CompressedCache.h"
+#include "FileTier.h"
+#include "WriteBackCache.h"
+#include "AsyncCache.h"
+#include "HotKeyCache.h"
+#include "ShmCache.h"
+#include "AdaptiveCaches.h"
+#include "GdsfCache.h"
+#include "FixedLruCache.h"
+#include "NegativeCache.h"
+#include "TenantCache.h"
+#include "SampledCache.h"
+#include "TaggedCache.h"
 
 class Timer {
 public:
@@ -29,15 +62,19 @@ private:
 };
 
 void printResults(const std::string& testName, int capacity, 
+                 const std::vector<std::string>& names,
                  const std::vector<int>& get_operations, 
-                 const std::vector<int>& hits) {
+                 const std::vector<int>& hits,
+                 const std::vector<double>& elapsed = {}) {
     std::cout << "缓存大小: " << capacity << std::endl;
-    std::cout << "LRU - 命中率: " << std::fixed << std::setprecision(2) 
-              << (100.0 * hits[0] / get_operations[0]) << "%" << std::endl;
-    std::cout << "LFU - 命中率: " << std::fixed << std::setprecision(2) 
-              << (100.0 * hits[1] / get_operations[1]) << "%" << std::endl;
-    std::cout << "ARC - 命中率: " << std::fixed << std::setprecision(2) 
-              << (100.0 * hits[2] / get_operations[2]) << "%" << std::endl;
+    for (size_t i = 0; i < names.size(); ++i) {
+        std::cout << names[i] << " - 命中率: " << std::fixed << std::setprecision(2) 
+                  << (100.0 * hits[i] / get_operations[i]) << "%";
+        if (i < elapsed.size()) {
+            std::cout << "  耗时: " << std::setprecision(0) << elapsed[i] << "ms";
+        }
+        std::cout << std::endl;
+    }
 }
 
 void testHotDataAccess() {
@@ -51,13 +88,20 @@ void testHotDataAccess() {
     MyCache::LruBase<int, std::string> lru(CAPACITY);
     MyCache::LfuBase<int, std::string> lfu(CAPACITY);
     MyCache::ArcCache<int, std::string> arc(CAPACITY);
+    MyCache::LirsCache<int, std::string> lirs(CAPACITY);
+    MyCache::S3FifoCache<int, std::string> s3fifo(CAPACITY);
+    MyCache::AdaptiveArcCache<int, std::string> arcP(CAPACITY);
+    MyCache::SampledCache<int, std::string> sampledLru(CAPACITY, MyCache::SampledPolicy::Lru);
+    MyCache::SampledCache<int, std::string> sampledLfu(CAPACITY, MyCache::SampledPolicy::Lfu);
 
     std::random_device rd;
     std::mt19937 gen(rd());
     
-    std::array<MyCache::CacheSer<int, std::string>*, 3> caches = {&lru, &lfu, &arc};
-    std::vector<int> hits(3, 0);
-    std::vector<int> get_operations(3, 0);
+    std::vector<MyCache::CacheSer<int, std::string>*> caches = {&lru, &lfu, &arc, &lirs, &s3fifo, &arcP,
+                                                                &sampledLru, &sampledLfu};
+    std::vector<std::string> names = {"LRU", "LFU", "ARC", "LIRS", "S3-FIFO", "ARC(p)", "LRU(采样)", "LFU(采样)"};
+    std::vector<int> hits(caches.size(), 0);
+    std::vector<int> get_operations(caches.size(), 0);
 
     // 先进行一系列put操作
     for (int i = 0; i < caches.size(); ++i) {
@@ -89,7 +133,7 @@ void testHotDataAccess() {
         }
     }
 
-    printResults("热点数据访问测试", CAPACITY, get_operations, hits);
+    printResults("热点数据访问测试", CAPACITY, names, get_operations, hits);
 }
 
 void testLoopPattern() {
@@ -102,10 +146,17 @@ void testLoopPattern() {
     MyCache::LruBase<int, std::string> lru(CAPACITY);
     MyCache::LfuBase<int, std::string> lfu(CAPACITY);
     MyCache::ArcCache<int, std::string> arc(CAPACITY);
+    MyCache::LirsCache<int, std::string> lirs(CAPACITY);
+    MyCache::S3FifoCache<int, std::string> s3fifo(CAPACITY);
+    MyCache::AdaptiveArcCache<int, std::string> arcP(CAPACITY);
+    MyCache::SampledCache<int, std::string> sampledLru(CAPACITY, MyCache::SampledPolicy::Lru);
+    MyCache::SampledCache<int, std::string> sampledLfu(CAPACITY, MyCache::SampledPolicy::Lfu);
 
-    std::array<MyCache::CacheSer<int, std::string>*, 3> caches = {&lru, &lfu, &arc};
-    std::vector<int> hits(3, 0);
-    std::vector<int> get_operations(3, 0);
+    std::vector<MyCache::CacheSer<int, std::string>*> caches = {&lru, &lfu, &arc, &lirs, &s3fifo, &arcP,
+                                                                &sampledLru, &sampledLfu};
+    std::vector<std::string> names = {"LRU", "LFU", "ARC", "LIRS", "S3-FIFO", "ARC(p)", "LRU(采样)", "LFU(采样)"};
+    std::vector<int> hits(caches.size(), 0);
+    std::vector<int> get_operations(caches.size(), 0);
 
     std::random_device rd;
     std::mt19937 gen(rd());
@@ -138,7 +189,7 @@ void testLoopPattern() {
         }
     }
 
-    printResults("循环扫描测试", CAPACITY, get_operations, hits);
+    printResults("循环扫描测试", CAPACITY, names, get_operations, hits);
 }
 
 void testWorkloadShift() {
@@ -151,15 +202,24 @@ void testWorkloadShift() {
     MyCache::LruBase<int, std::string> lru(CAPACITY);
     MyCache::LfuBase<int, std::string> lfu(CAPACITY);
     MyCache::ArcCache<int, std::string> arc(CAPACITY);
+    MyCache::LirsCache<int, std::string> lirs(CAPACITY);
+    MyCache::S3FifoCache<int, std::string> s3fifo(CAPACITY);
+    MyCache::AdaptiveArcCache<int, std::string> arcP(CAPACITY);
+    MyCache::SampledCache<int, std::string> sampledLru(CAPACITY, MyCache::SampledPolicy::Lru);
+    MyCache::SampledCache<int, std::string> sampledLfu(CAPACITY, MyCache::SampledPolicy::Lfu);
 
     std::random_device rd;
     std::mt19937 gen(rd());
-    std::array<MyCache::CacheSer<int, std::string>*, 3> caches = {&lru, &lfu, &arc};
-    std::vector<int> hits(3, 0);
-    std::vector<int> get_operations(3, 0);
+    std::vector<MyCache::CacheSer<int, std::string>*> caches = {&lru, &lfu, &arc, &lirs, &s3fifo, &arcP,
+                                                                &sampledLru, &sampledLfu};
+    std::vector<std::string> names = {"LRU", "LFU", "ARC", "LIRS", "S3-FIFO", "ARC(p)", "LRU(采样)", "LFU(采样)"};
+    std::vector<int> hits(caches.size(), 0);
+    std::vector<int> get_operations(caches.size(), 0);
+    std::vector<double> elapsed(caches.size(), 0);
 
     // 先填充一些初始数据
     for (int i = 0; i < caches.size(); ++i) {
+        Timer timer;
         for (int key = 0; key < 1000; ++key) {
             std::string value = "init" + std::to_string(key);
             caches[i]->put(key, value);
@@ -201,14 +261,1342 @@ void testWorkloadShift() {
                 caches[i]->put(key, value);
             }
         }
+        elapsed[i] = timer.elapsed();
+    }
+
+    printResults("工作负载剧烈变化测试", CAPACITY, names, get_operations, hits, elapsed);
+}
+
+// 多线程读多写少：98% get + 2% put，比较加锁LRU与无锁读路径的吞吐随线程数的变化
+double runConcurrentReads(MyCache::CacheSer<int, std::string>& cache, int threadNum,
+                          int opsPerThread, int keyRange) {
+    std::vector<std::thread> threads;
+    Timer timer;
+    for (int t = 0; t < threadNum; ++t) {
+        threads.emplace_back([&cache, t, opsPerThread, keyRange]() {
+            std::mt19937 gen(t + 1);
+            std::string result;
+            for (int op = 0; op < opsPerThread; ++op) {
+                int key = gen() % keyRange;
+                if (op % 100 < 98) {
+                    cache.get(key, result);
+                } else {
+                    cache.put(key, "value" + std::to_string(key));
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    double ms = timer.elapsed();
+    return ms > 0 ? (static_cast<double>(threadNum) * opsPerThread / ms) : 0;
+}
+
+void testConcurrentRead() {
+    std::cout << "\n=== 测试场景4：多线程读多写少测试 ===" << std::endl;
+
+    const int CAPACITY = 10000;
+    const int KEY_RANGE = 12000;
+    const int OPS_PER_THREAD = 200000;
+
+    for (int threadNum : {1, 2, 4, 8}) {
+        MyCache::LruBase<int, std::string> lru(CAPACITY);
+        MyCache::EpochLruCache<int, std::string> epochLru(CAPACITY);
+        for (int key = 0; key < KEY_RANGE; ++key) {
+            lru.put(key, "value" + std::to_string(key));
+            epochLru.put(key, "value" + std::to_string(key));
+        }
+
+        std::cout << "线程数: " << threadNum
+                  << " LRU: " << std::fixed << std::setprecision(0)
+                  << runConcurrentReads(lru, threadNum, OPS_PER_THREAD, KEY_RANGE) << " ops/ms"
+                  << " EpochLRU: "
+                  << runConcurrentReads(epochLru, threadNum, OPS_PER_THREAD, KEY_RANGE) << " ops/ms"
+                  << " (容量 " << epochLru.size() << "/" << CAPACITY << ")" << std::endl;
+    }
+}
+
+// 持续淘汰下的 slab 内存：值大小随机，观察映射内存是否跟随实际数据量
+void testSlabChurn() {
+    std::cout << "\n=== 测试场景5：slab 值存储淘汰抖动测试 ===" << std::endl;
+
+    const int CAPACITY = 2000;
+    const int OPERATIONS = 200000;
+    const int KEY_RANGE = 100000;
+
+    MyCache::HashSlabCaches<int> cache(CAPACITY, 4);
+    std::mt19937 gen(42);
+    std::string value;
+    for (int op = 1; op <= OPERATIONS; ++op) {
+        int key = gen() % KEY_RANGE;
+        // 前半段以小值为主，后半段以大值为主，迫使页面在 size class 之间迁移
+        size_t size = (op < OPERATIONS / 2) ? 64 + gen() % 512 : 2048 + gen() % 6144;
+        value.assign(size, static_cast<char>('a' + key % 26));
+        cache.put(key, value);
+
+        if (op % (OPERATIONS / 4) == 0) {
+            auto stats = cache.memoryStats();
+            std::cout << "操作数: " << op
+                      << " 有效数据: " << stats.payloadBytes / 1024 << "KB"
+                      << " chunk 占用: " << stats.chunkBytes / 1024 << "KB"
+                      << " 映射页面: " << stats.mappedBytes / 1024 << "KB" << std::endl;
+        }
+    }
+
+    // 超过一页的值单独映射，覆盖后旧映射随之释放
+    bool largeOk = true;
+    for (size_t size : {size_t(64) << 10, size_t(300) << 10, size_t(2) << 20}) {
+        std::string large(size, 'L');
+        cache.put(-1, large);
+        largeOk = largeOk && cache.get(-1) == large;
+    }
+    auto stats = cache.memoryStats();
+    std::cout << "大值读写正确: " << (largeOk ? "是" : "否") << " 大块数: " << stats.largeChunks << std::endl;
+}
+
+// 多 KB 的 JSON 值：相同字节容量下，压缩后能容纳更多条目
+std::string makeJsonBlob(int key, size_t approxSize) {
+    std::string blob = "[";
+    for (int i = 0; blob.size() < approxSize; ++i) {
+        blob += "{\"id\":" + std::to_string(key * 1000 + i) + ",\"name\":\"user" + std::to_string(i % 37)
+              + "\",\"active\":" + (i % 3 ? "true" : "false") + ",\"score\":" + std::to_string((key * 7 + i) % 100) + "},";
+    }
+    blob.back() = ']';
+    return blob;
+}
+
+void testCompression() {
+    std::cout << "\n=== 测试场景6：大值透明压缩测试 ===" << std::endl;
+
+    const size_t CAPACITY_BYTES = 4 << 20;
+    const int KEY_RANGE = 3000;
+    const int OPERATIONS = 100000;
+
+    for (size_t threshold : {static_cast<size_t>(-1), static_cast<size_t>(1024)}) {
+        MyCache::HashCompressedCaches<int> cache(CAPACITY_BYTES, 4, threshold);
+        std::mt19937 gen(7);
+        int hits = 0;
+        std::string result;
+        for (int op = 0; op < OPERATIONS; ++op) {
+            int key = std::min(gen() % KEY_RANGE, gen() % KEY_RANGE);
+            if (cache.get(key, result)) {
+                hits++;
+            } else {
+                cache.put(key, makeJsonBlob(key, 2048 + key % 6144));
+            }
+        }
+
+        auto stats = cache.stats();
+        std::cout << (threshold == static_cast<size_t>(-1) ? "不压缩" : "压缩")
+                  << " - 命中率: " << std::fixed << std::setprecision(2) << (100.0 * hits / OPERATIONS) << "%"
+                  << " 压缩比: " << stats.ratio()
+                  << " 平均压缩耗时: " << (stats.compressedPuts ? stats.compressNanos / 1000.0 / stats.compressedPuts : 0) << "us"
+                  << " 平均解压耗时: " << (stats.decompressCount ? stats.decompressNanos / 1000.0 / stats.decompressCount : 0) << "us"
+                  << std::endl;
+    }
+}
+
+// 内存 + 本地文件两级缓存：工作集大于内存容量时，被淘汰的条目仍可从文件层取回
+void testFileTier() {
+    std::cout << "\n=== 测试场景7：内存 + 文件两级缓存测试 ===" << std::endl;
+
+    const int CAPACITY = 1000;
+    const int KEY_RANGE = 8000;
+    const int OPERATIONS = 100000;
+    std::string dir = (std::filesystem::temp_directory_path() / "mycache-tier-test").string();
+
+    MyCache::LruBase<int, std::string> memoryOnly(CAPACITY);
+    MyCache::HashTieredCaches<int, std::string> tiered(CAPACITY, 4, dir, 1 << 20);
+    std::vector<int> hits(2, 0);
+    int mismatches = 0;
+    std::mt19937 gen(11);
+    std::string result;
+    for (int op = 0; op < OPERATIONS; ++op) {
+        int key = std::min(gen() % KEY_RANGE, gen() % KEY_RANGE);
+        std::string value = "tier" + std::to_string(key) + std::string(200, 'x');
+        if (memoryOnly.get(key, result)) {
+            hits[0]++;
+        } else {
+            memoryOnly.put(key, value);
+        }
+        if (tiered.get(key, result)) {
+            hits[1]++;
+            mismatches += result != value;
+        } else {
+            tiered.put(key, value);
+        }
+    }
+
+    tiered.tier().flush();
+    auto stats = tiered.tier().stats();
+    std::cout << "仅内存 - 命中率: " << std::fixed << std::setprecision(2) << (100.0 * hits[0] / OPERATIONS) << "%" << std::endl;
+    std::cout << "两级缓存 - 命中率: " << (100.0 * hits[1] / OPERATIONS) << "%"
+              << " 值不一致: " << mismatches
+              << " 文件层命中: " << stats.hits
+              << " 段文件: " << stats.segments
+              << " 文件大小: " << stats.fileBytes / 1024 << "KB"
+              << " 有效数据: " << stats.liveBytes / 1024 << "KB"
+              << " 压缩次数: " << stats.compactions
+              << " 写入失败: " << stats.writeErrors << std::endl;
+}
+
+// 淘汰通知：锁内只记入缓冲，锁外批量回调；回调里可以再次访问缓存
+void testEvictionListener() {
+    std::cout << "\n=== 测试场景8：淘汰通知测试 ===" << std::endl;
+
+    const int CAPACITY = 500;
+    const int KEY_RANGE = 2000;
+    const int OPERATIONS = 100000;
+
+    MyCache::HashLruCaches<int, std::string> lru(CAPACITY, 4);
+    MyCache::HashLfu<int, std::string> lfu(CAPACITY, 4);
+    for (int policy = 0; policy < 2; ++policy) {
+        std::array<std::atomic<int>, 4> causes{};
+        std::atomic<int> batches{0};
+        std::string probe;
+        auto listener = [&](const std::vector<MyCache::EvictionEvent<int, std::string>>& events) {
+            batches++;
+            for (const auto& event : events) {
+                causes[static_cast<int>(event.cause)]++;
+            }
+            // 回调在分片锁外执行，重新进入缓存不会死锁
+            policy == 0 ? lru.get(events.front().key, probe) : lfu.get(events.front().key, probe);
+        };
+        policy == 0 ? lru.setEvictionListener(listener) : lfu.setEvictionListener(listener);
+
+        std::mt19937 gen(3);
+        std::string value;
+        for (int op = 0; op < OPERATIONS; ++op) {
+            int key = gen() % KEY_RANGE;
+            int action = gen() % 10;
+            if (action == 0) {
+                policy == 0 ? lru.remove(key) : lfu.remove(key);
+            } else if (!(policy == 0 ? lru.get(key, value) : lfu.get(key, value)) || action == 1) {
+                policy == 0 ? lru.put(key, "value" + std::to_string(op)) : lfu.put(key, "value" + std::to_string(op));
+            }
+        }
+        policy == 0 ? lru.flushEvictions() : lfu.flushEvictions();
+        policy == 0 ? lru.setEvictionListener(nullptr) : lfu.setEvictionListener(nullptr);
+
+        std::cout << (policy == 0 ? "LRU" : "LFU")
+                  << " - 容量淘汰: " << causes[0] << " 显式删除: " << causes[1]
+                  << " 覆盖: " << causes[2] << " 回调批次: " << batches << std::endl;
+    }
+}
+
+// 回写模式：用内存中的桩存储代替慢速下游，检查合并写入与最终一致
+void testWriteBack() {
+    std::cout << "\n=== 测试场景9：回写模式测试 ===" << std::endl;
+
+    const int CAPACITY = 500;
+    const int KEY_RANGE = 2000;
+    const int OPERATIONS = 100000;
+
+    std::mutex storeMutex;
+    std::unordered_map<int, std::string> store;
+    int storeWrites = 0;
+    int writerCalls = 0;
+    auto writer = [&](const std::vector<std::pair<int, std::optional<std::string>>>& batch) {
+        std::lock_guard<std::mutex> lock(storeMutex);
+        // 每 7 次调用失败一次，验证失败后重试且不会用旧值覆盖新值
+        if (++writerCalls % 7 == 0) {
+            return false;
+        }
+        for (const auto& [key, value] : batch) {
+            if (value) {
+                store[key] = *value;
+            } else {
+                store.erase(key);
+            }
+            storeWrites++;
+        }
+        return true;
+    };
+
+    std::unordered_map<int, std::string> expected;
+    size_t dropped = 0;
+    auto onDrop = [&](const std::vector<std::pair<int, std::optional<std::string>>>& batch) {
+        dropped += batch.size();
+    };
+    Timer timer;
+    {
+        MyCache::HashWriteBackCaches<int, std::string> cache(CAPACITY, 4, writer, 64, std::chrono::milliseconds(5));
+        cache.setShutdownPolicy(std::chrono::milliseconds(1000), onDrop);
+        std::mt19937 gen(5);
+        std::string value;
+        int staleReads = 0;
+        for (int op = 0; op < OPERATIONS; ++op) {
+            int key = std::min(gen() % KEY_RANGE, gen() % KEY_RANGE);
+            int action = gen() % 30;
+            if (action < 10) {
+                expected[key] = "value" + std::to_string(op);
+                cache.put(key, expected[key]);
+            } else if (action == 10) {
+                // 删除后不能再从脏表或在途批次中读回
+                expected.erase(key);
+                cache.remove(key);
+            } else {
+                auto it = expected.find(key);
+                // 已落盘并被淘汰的条目未命中是正常的，命中时必须是最新值
+                if (cache.get(key, value) && (it == expected.end() || value != it->second)) {
+                    staleReads++;
+                }
+            }
+        }
+        cache.flush();
+        auto stats = cache.stats();
+        std::cout << "写入次数: " << stats.puts << " 删除次数: " << stats.removes << " 合并: " << stats.coalesced
+                  << " 落盘条目: " << stats.flushedEntries << " 批次: " << stats.batches
+                  << " 失败批次: " << stats.failedBatches << " 读到旧值: " << staleReads << std::endl;
+    }
+
+    int mismatches = 0;
+    for (int key = 0; key < KEY_RANGE; ++key) {
+        auto want = expected.find(key);
+        auto got = store.find(key);
+        mismatches += (want == expected.end()) != (got == store.end())
+                   || (want != expected.end() && got->second != want->second);
+    }
+    std::cout << "下游写入: " << storeWrites << " 最终不一致: " << mismatches << " 析构丢弃: " << dropped
+              << " 耗时: " << std::fixed << std::setprecision(2) << timer.elapsed() << "ms" << std::endl;
+
+    // 下游一直不可用：析构重试到期限后把剩余条目交给 onDrop
+    dropped = 0;
+    {
+        auto failing = [](const std::vector<std::pair<int, std::optional<std::string>>>&) { return false; };
+        MyCache::HashWriteBackCaches<int, std::string> cache(CAPACITY, 4, failing, 64, std::chrono::milliseconds(5));
+        cache.setShutdownPolicy(std::chrono::milliseconds(20), onDrop);
+        for (int key = 0; key < 100; ++key) {
+            cache.put(key, "value" + std::to_string(key));
+        }
+    }
+    std::cout << "下游不可用 - 写入条目: 100 析构丢弃: " << dropped << std::endl;
+}
+
+// 只用于测试的协程类型：创建后立即执行，结束时自行销毁
+struct DetachedTask {
+    struct promise_type {
+        DetachedTask get_return_object() { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+// 恢复协程用的工作线程池，作为 HashAsyncCaches 的 executor
+class ResumePool {
+public:
+    explicit ResumePool(int threadNum) {
+        for (int i = 0; i < threadNum; ++i) {
+            workers_.emplace_back([this]() { run(); });
+        }
+    }
+
+    ~ResumePool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        for (auto& worker : workers_) {
+            worker.join();
+        }
+    }
+
+    void post(std::coroutine_handle<> handle) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            queue_.push_back(handle);
+        }
+        cv_.notify_one();
+    }
+
+private:
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            cv_.wait(lock, [this]() { return stop_ || !queue_.empty(); });
+            if (queue_.empty()) {
+                return;
+            }
+            auto handle = queue_.front();
+            queue_.pop_front();
+            lock.unlock();
+            handle.resume();
+            lock.lock();
+        }
+    }
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<std::coroutine_handle<>> queue_;
+    std::vector<std::thread> workers_;
+    bool stop_ = false;
+};
+
+// 模拟远端加载：请求在固定延迟后由定时线程回调完成
+class DelayedLoader {
+public:
+    using Done = std::function<void(bool, std::string)>;
+
+    explicit DelayedLoader(std::chrono::microseconds delay) : delay_(delay), thread_([this]() { run(); }) {}
+
+    ~DelayedLoader() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        thread_.join();
+    }
+
+    void load(int key, Done done) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            requests_.push_back({std::chrono::steady_clock::now() + delay_, key, std::move(done)});
+            calls_++;
+        }
+        cv_.notify_one();
+    }
+
+    int calls() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return calls_;
+    }
+
+private:
+    struct Request {
+        std::chrono::steady_clock::time_point deadline;
+        int key;
+        Done done;
+    };
+
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!stop_) {
+            if (requests_.empty()) {
+                cv_.wait(lock);
+                continue;
+            }
+            // 延迟固定，先到的请求先到期
+            if (cv_.wait_until(lock, requests_.front().deadline) == std::cv_status::no_timeout) {
+                continue;
+            }
+            Request request = std::move(requests_.front());
+            requests_.pop_front();
+            lock.unlock();
+            request.done(true, "remote" + std::to_string(request.key));
+            lock.lock();
+        }
+    }
+
+    std::chrono::microseconds delay_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<Request> requests_;
+    int calls_ = 0;
+    bool stop_ = false;
+    std::thread thread_;
+};
+
+DetachedTask lookupTask(MyCache::HashAsyncCaches<int, std::string>& cache, DelayedLoader& loader, int key,
+                        std::atomic<int>& done, std::atomic<int>& wrong) {
+    auto value = co_await cache.getOrLoadAsync(key, [&loader](const int& k, auto finish) {
+        loader.load(k, std::move(finish));
+    });
+    if (!value || *value != "remote" + std::to_string(key)) {
+        wrong++;
+    }
+    done++;
+}
+
+// loader 同步抛出异常：异常从 co_await 抛出，在途记录被撤销
+DetachedTask throwingTask(MyCache::HashAsyncCaches<int, std::string>& cache, int key, std::atomic<int>& caught) {
+    try {
+        co_await cache.getOrLoadAsync(key, [](const int&, auto) { throw std::runtime_error("loader down"); });
+    } catch (const std::runtime_error&) {
+        caught++;
+    }
+}
+
+// 大量协程并发读：命中不挂起，同一 key 的并发未命中只触发一次加载
+void testAsyncLoad() {
+    std::cout << "\n=== 测试场景10：协程异步加载测试 ===" << std::endl;
+
+    const int CAPACITY = 2000;
+    const int KEY_RANGE = 5000;
+    const int COROUTINES = 50000;
+
+    ResumePool pool(2);
+    DelayedLoader loader(std::chrono::microseconds(500));
+    MyCache::HashAsyncCaches<int, std::string> cache(CAPACITY, 4,
+                                                     [&pool](std::coroutine_handle<> handle) { pool.post(handle); });
+    std::atomic<int> done{0};
+    std::atomic<int> wrong{0};
+    std::mt19937 gen(9);
+
+    Timer timer;
+    for (int i = 0; i < COROUTINES; ++i) {
+        int key = std::min(gen() % KEY_RANGE, gen() % KEY_RANGE);
+        lookupTask(cache, loader, key, done, wrong);
+    }
+    while (done < COROUTINES) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    auto stats = cache.stats();
+    std::cout << "协程数: " << COROUTINES << " 同步命中: " << stats.hits
+              << " 加载次数: " << stats.loads << " 合并等待: " << stats.coalesced
+              << " 远端调用: " << loader.calls() << " 结果错误: " << wrong
+              << " 耗时: " << timer.elapsed() << "ms" << std::endl;
+
+    // 抛异常之后同一 key 仍能正常加载，不会挂在残留的在途记录上
+    std::atomic<int> caught{0};
+    int missingKey = KEY_RANGE + 1;
+    throwingTask(cache, missingKey, caught);
+    lookupTask(cache, loader, missingKey, done, wrong);
+    while (done < COROUTINES + 1) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    std::cout << "loader 抛出异常 - 捕获: " << caught << " 之后重新加载结果错误: " << wrong << std::endl;
+}
+
+// 少数极热 key 集中在个别分片上：热点识别 + 线程局部近端缓存，同时检查每个读线程看到的版本单调不减
+void testHotKeys() {
+    std::cout << "\n=== 测试场景11：热点 key 近端缓存测试 ===" << std::endl;
+
+    const int CAPACITY = 5000;
+    const int KEY_RANGE = 20000;
+    const int HOT_KEYS = 4;
+    const int OPS_PER_THREAD = 200000;
+    const int THREADS = 4;
+
+    for (bool nearCache : {false, true}) {
+        MyCache::HashHotKeyCaches<int, int> cache(CAPACITY, 8, nearCache);
+        for (int key = 0; key < KEY_RANGE; ++key) {
+            cache.put(key, 0);
+        }
+
+        std::atomic<int> regressions{0};
+        std::atomic<uint64_t> nearHits{0};
+        std::vector<std::thread> threads;
+        Timer timer;
+        for (int t = 0; t < THREADS; ++t) {
+            threads.emplace_back([&, t]() {
+                std::mt19937 gen(t);
+                std::array<int, HOT_KEYS> lastSeen{};
+                int value;
+                for (int op = 0; op < OPS_PER_THREAD; ++op) {
+                    // 一半访问落在 HOT_KEYS 个热点上
+                    int key = gen() % 2 ? gen() % HOT_KEYS : gen() % KEY_RANGE;
+                    if (t == 0 && op % 100 == 0) {
+                        cache.put(key, op);
+                    } else if (cache.get(key, value) && key < HOT_KEYS && t != 0) {
+                        if (value < lastSeen[key]) {
+                            regressions++;
+                        }
+                        lastSeen[key] = value;
+                    }
+                }
+                nearHits += cache.nearHits();
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        std::cout << (nearCache ? "近端缓存" : "仅分片") << " - 吞吐: "
+                  << static_cast<long long>(THREADS * OPS_PER_THREAD / std::max(1.0, timer.elapsed())) << " ops/ms"
+                  << " L1 命中: " << nearHits << " 读到回退值: " << regressions << std::endl;
+        std::cout << "top-K:";
+        for (const auto& counter : cache.topK(6)) {
+            std::cout << " " << counter.key << "(" << counter.count << ")";
+        }
+        std::cout << std::endl;
+    }
+}
+
+// 热点工作集 + 周期性一次性扫描：比较开启扫描识别前后热点部分的命中率
+void testScanResistance() {
+    std::cout << "\n=== 测试场景12：扫描抵抗测试 ===" << std::endl;
+
+    const int CAPACITY = 1000;
+    const int HOT_SET = 800;
+    const int OPERATIONS = 300000;
+    const int SCAN_LENGTH = 3000;
+
+    for (bool sharded : {false, true}) {
+        for (bool resistant : {false, true}) {
+            MyCache::LruBase<int, int> single(CAPACITY);
+            MyCache::HashLruCaches<int, int> hashed(CAPACITY, 4);
+            if (resistant) {
+                single.setScanResistance(true);
+                hashed.setScanResistance(true);
+            }
+
+            std::mt19937 gen(13);
+            int hotGets = 0;
+            int hotHits = 0;
+            int scanKey = 1000000;
+            int value;
+            for (int op = 0; op < OPERATIONS; ++op) {
+                // 每 20000 次操作插入一次长度为 SCAN_LENGTH 的顺序扫描，扫描的 key 不再被访问
+                bool scanning = op % 20000 < SCAN_LENGTH;
+                int key;
+                if (scanning) {
+                    key = scanKey++;
+                } else if (gen() % 10 < 9) {
+                    key = gen() % HOT_SET;
+                } else {
+                    key = 100000 + gen() % 100000;
+                }
+
+                bool hit = sharded ? hashed.get(key, value) : single.get(key, value);
+                if (!hit) {
+                    sharded ? hashed.put(key, key) : single.put(key, key);
+                }
+                if (key < HOT_SET) {
+                    hotGets++;
+                    hotHits += hit;
+                }
+            }
+            std::cout << (sharded ? "HashLRU" : "LRU") << (resistant ? " + 扫描识别" : "")
+                      << " - 热点命中率: " << std::fixed << std::setprecision(2)
+                      << (100.0 * hotHits / hotGets) << "%" << std::endl;
+        }
+    }
+}
+
+// 多线程对少量计数器做读改写，分别用 compute 与 compareAndSet，检查最终计数没有丢失更新
+template<typename Cache>
+std::pair<long long, long long> runAtomicIncrements(Cache& cache, int threadNum, int opsPerThread, int counters) {
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadNum; ++t) {
+        threads.emplace_back([&, t]() {
+            for (int op = 0; op < opsPerThread; ++op) {
+                int key = (op * 7 + t) % counters;
+                if (op % 2) {
+                    cache.compute(key, [](const long long* current) { return (current ? *current : 0) + 1; });
+                } else {
+                    cache.merge(key, 1LL, [](long long old, long long delta) { return old + delta; });
+                }
+                // CAS 计数器与上面的 key 不重叠
+                int casKey = counters + key;
+                cache.merge(casKey, 0LL, [](long long old, long long) { return old; });
+                while (true) {
+                    long long observed = 0;
+                    cache.computeIfPresent(casKey, [&](long long value) { observed = value; return value; });
+                    if (cache.compareAndSet(casKey, observed, observed + 1)) {
+                        break;
+                    }
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    long long computeTotal = 0;
+    long long casTotal = 0;
+    long long value;
+    for (int key = 0; key < counters; ++key) {
+        computeTotal += cache.get(key, value) ? value : 0;
+        casTotal += cache.get(counters + key, value) ? value : 0;
+    }
+    return {computeTotal, casTotal};
+}
+
+void testAtomicUpdates() {
+    std::cout << "\n=== 测试场景13：原子读改写测试 ===" << std::endl;
+
+    const int THREADS = 4;
+    const int OPS_PER_THREAD = 20000;
+    const int COUNTERS = 16;
+    const int CAPACITY = 64;
+
+    MyCache::LruBase<int, long long> lru(CAPACITY);
+    MyCache::LfuBase<int, long long> lfu(CAPACITY);
+    MyCache::ArcCache<int, long long> arc(CAPACITY);
+    MyCache::AdaptiveArcCache<int, long long> arcP(CAPACITY);
+    MyCache::HashLruCaches<int, long long> hashLru(CAPACITY, 4);
+    MyCache::HashLfu<int, long long> hashLfu(CAPACITY, 4);
+
+    std::vector<std::string> names = {"LRU", "LFU", "ARC", "ARC(p)", "HashLRU", "HashLFU"};
+    std::vector<std::pair<long long, long long>> totals = {
+        runAtomicIncrements(lru, THREADS, OPS_PER_THREAD, COUNTERS),
+        runAtomicIncrements(lfu, THREADS, OPS_PER_THREAD, COUNTERS),
+        runAtomicIncrements(arc, THREADS, OPS_PER_THREAD, COUNTERS),
+        runAtomicIncrements(arcP, THREADS, OPS_PER_THREAD, COUNTERS),
+        runAtomicIncrements(hashLru, THREADS, OPS_PER_THREAD, COUNTERS),
+        runAtomicIncrements(hashLfu, THREADS, OPS_PER_THREAD, COUNTERS),
+    };
+    std::cout << "期望计数: " << THREADS * OPS_PER_THREAD << std::endl;
+    for (size_t i = 0; i < names.size(); ++i) {
+        std::cout << names[i] << " - compute/merge: " << totals[i].first
+                  << " compareAndSet: " << totals[i].second << std::endl;
+    }
+}
+
+// 多个 fork 出的进程共享同一个共享内存段；最后一个子进程在分片锁内退出，检验分片重建
+void testSharedMemory() {
+    std::cout << "\n=== 测试场景14：多进程共享内存缓存测试 ===" << std::endl;
+
+    const int PROCESSES = 4;
+    const int OPERATIONS = 50000;
+    const int KEY_RANGE = 4000;
+    const int CAPACITY = 1000;
+    const int INCREMENTS = 5000;
+    std::string dataName = "/mycache-shm-test-data";
+    std::string counterName = "/mycache-shm-test-counter";
+    MyCache::HashShmCaches<int, std::string>::destroy(dataName);
+    MyCache::HashShmCaches<int, long long>::destroy(counterName);
+
+    MyCache::HashShmCaches<int, std::string> cache(dataName, CAPACITY, 4);
+    MyCache::HashShmCaches<int, long long> counters(counterName, 16, 1);
+
+    std::vector<pid_t> children;
+    for (int p = 0; p < PROCESSES; ++p) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            // 子进程各自打开同名段，不复用父进程的映射
+            MyCache::HashShmCaches<int, std::string> shared(dataName, CAPACITY, 4);
+            MyCache::HashShmCaches<int, long long> sharedCounters(counterName, 16, 1);
+            std::mt19937 gen(100 + p);
+            int mismatches = 0;
+            std::string result;
+            for (int op = 0; op < OPERATIONS; ++op) {
+                int key = std::min(gen() % KEY_RANGE, gen() % KEY_RANGE);
+                std::string value = "shm" + std::to_string(key);
+                if (shared.get(key, result)) {
+                    mismatches += result != value;
+                } else {
+                    shared.put(key, value);
+                }
+                if (op < INCREMENTS) {
+                    sharedCounters.merge(0, 1, [](long long a, long long b) { return std::optional<long long>(a + b); });
+                }
+            }
+            _exit(mismatches == 0 ? 0 : 1);
+        }
+        children.push_back(pid);
+    }
+
+    int failed = 0;
+    for (pid_t pid : children) {
+        int status = 0;
+        waitpid(pid, &status, 0);
+        failed += !(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    }
+    auto beforeCrash = cache.stats();
+
+    // 在分片锁内直接退出，锁的持有者就此消失
+    pid_t crasher = fork();
+    if (crasher == 0) {
+        MyCache::HashShmCaches<int, std::string> shared(dataName, CAPACITY, 4);
+        shared.mutate(1, [](const std::string*) -> MyCache::Mutation<std::string> { _exit(0); });
+        _exit(1);
+    }
+    waitpid(crasher, nullptr, 0);
+    cache.put(1, "shm1");
+    std::string value;
+    bool recovered = cache.get(1, value) && value == "shm1";
+    auto afterCrash = cache.stats();
+
+    long long expected = static_cast<long long>(PROCESSES) * INCREMENTS;
+    std::cout << "子进程: " << PROCESSES << " 值不一致的子进程: " << failed
+              << " 共享命中率: " << std::fixed << std::setprecision(2)
+              << (100.0 * beforeCrash.hits / (beforeCrash.hits + beforeCrash.misses)) << "%"
+              << " 条目数: " << beforeCrash.size << std::endl;
+    std::cout << "跨进程计数: " << counters.get(0) << " (期望 " << expected << ")" << std::endl;
+    std::cout << "分片重建次数: " << afterCrash.recoveries << " 重建后读写正常: " << (recovered ? "是" : "否")
+              << " 剩余条目: " << afterCrash.size << std::endl;
+
+    MyCache::HashShmCaches<int, std::string>::destroy(dataName);
+    MyCache::HashShmCaches<int, long long>::destroy(counterName);
+}
+
+// 两个阶段：先是固定热点夹杂大量只出现一次的 key（偏向频率类策略），再是不断平移的工作集（偏向 LRU）
+void testAdaptivePolicy() {
+    std::cout << "\n=== 测试场景15：分片自适应策略选择测试 ===" << std::endl;
+
+    const int CAPACITY = 2000;
+    const int SLICES = 4;
+    const int OPERATIONS = 400000;
+
+    MyCache::HashLruCaches<int, int> lru(CAPACITY, SLICES);
+    MyCache::HashLfu<int, int> lfu(CAPACITY, SLICES);
+    // 每个分片 500 个条目，影子缓存限制在分片的四分之一以内，只有约四分之一的读参与抽样；
+    // 周期按抽样访问计，相应缩短
+    MyCache::HashAdaptiveCaches<int, int> adaptive(CAPACITY, SLICES, MyCache::PolicyConfig{MyCache::PolicyKind::Lru, 0},
+                                                   256, 512);
+
+    auto printDecisions = [&]() {
+        auto decisions = adaptive.decisions();
+        for (size_t i = 0; i < decisions.size(); ++i) {
+            const auto& d = decisions[i];
+            std::cout << "  分片" << i << ": " << MyCache::policyName(d.active.kind);
+            if (d.active.kind != MyCache::PolicyKind::Lru) {
+                std::cout << "(" << d.active.param << ")";
+            }
+            std::cout << " 实际命中率: " << std::fixed << std::setprecision(2) << 100.0 * d.activeHitRatio << "%"
+                      << " 切换次数: " << d.switches
+                      << " 抽样比例: " << 100.0 * d.sampledGets / std::max<uint64_t>(d.gets, 1) << "%" << " 估计:";
+            for (const auto& e : d.estimates) {
+                std::cout << " " << MyCache::policyName(e.config.kind);
+                if (e.config.kind != MyCache::PolicyKind::Lru) {
+                    std::cout << "(" << e.config.param << ")";
+                }
+                std::cout << "=" << std::setprecision(1) << 100.0 * e.hitRatio << "%";
+            }
+            std::cout << std::endl;
+        }
+    };
+
+    std::mt19937 gen(23);
+    int nextUnique = 1 << 24;
+    for (int phase = 0; phase < 2; ++phase) {
+        std::vector<int> hits(3, 0);
+        for (int op = 0; op < OPERATIONS; ++op) {
+            int key;
+            if (phase == 0) {
+                key = gen() % 2 == 0 ? static_cast<int>(gen() % 1500) : nextUnique++;
+            } else {
+                key = (1 << 20) + op / 50 + static_cast<int>(gen() % 1500);
+            }
+            int value = 0;
+            if (lru.get(key, value)) hits[0]++; else lru.put(key, key);
+            if (lfu.get(key, value)) hits[1]++; else lfu.put(key, key);
+            if (adaptive.get(key, value)) hits[2]++; else adaptive.put(key, key);
+        }
+        std::cout << (phase == 0 ? "阶段一（热点 + 一次性 key）" : "阶段二（平移工作集）") << std::endl;
+        printResults("", CAPACITY, {"HashLRU", "HashLFU", "自适应"}, {OPERATIONS, OPERATIONS, OPERATIONS}, hits);
+        printDecisions();
+    }
+}
+
+// 按值的字节数计费的 LRU，与 GDSF 在同样的字节容量下比较
+class SizedLruCache : public MyCache::LruBase<int, std::string> {
+public:
+    using MyCache::LruBase<int, std::string>::LruBase;
+
+protected:
+    size_t charge(const std::string& value) const override { return value.size(); }
+};
+
+// 未命中代价与值大小都高度偏斜：10% 的 key 未命中要 500ms，其余 1ms；值大小 64B 到 4KB。
+// 以节省的总延迟（命中条目的代价之和）而不是命中率衡量
+void testCostAware() {
+    std::cout << "\n=== 测试场景16：代价感知淘汰（GDSF）测试 ===" << std::endl;
+
+    const int KEY_RANGE = 20000;
+    const int OPERATIONS = 400000;
+    const size_t CAPACITY_BYTES = 4 << 20;
+    const int SLICES = 4;
+
+    auto costOf = [](int key) { return key % 10 == 0 ? 500.0 : 1.0; };
+    auto sizeOf = [](int key) { return static_cast<size_t>(64) << ((key * 2654435761u) >> 29) % 7; };
+
+    MyCache::HashCaches<int, std::string, SizedLruCache> lru(CAPACITY_BYTES, SLICES);
+    MyCache::HashCaches<int, std::string, MyCache::GdsfCache<int, std::string>> gdsf(CAPACITY_BYTES, SLICES);
+
+    std::vector<int> hits(2, 0);
+    std::vector<double> saved(2, 0);
+    double totalCost = 0;
+    std::mt19937 gen(29);
+    std::string value;
+    for (int op = 0; op < OPERATIONS; ++op) {
+        int key = std::min(gen() % KEY_RANGE, gen() % KEY_RANGE);
+        double cost = costOf(key);
+        size_t size = sizeOf(key);
+        totalCost += cost;
+        if (lru.get(key, value)) {
+            hits[0]++;
+            saved[0] += cost;
+        } else {
+            lru.put(key, std::string(size, 'g'));
+        }
+        if (gdsf.get(key, value)) {
+            hits[1]++;
+            saved[1] += cost;
+        } else {
+            gdsf.put(key, std::string(size, 'g'), cost, size);
+        }
+    }
+
+    std::vector<std::string> names = {"LRU(按字节)", "GDSF"};
+    std::cout << "缓存字节数: " << CAPACITY_BYTES << " 总未命中代价: " << std::fixed << std::setprecision(0)
+              << totalCost / 1000 << "s" << std::endl;
+    for (size_t i = 0; i < names.size(); ++i) {
+        std::cout << names[i] << " - 命中率: " << std::setprecision(2) << (100.0 * hits[i] / OPERATIONS) << "%"
+                  << " 节省延迟: " << std::setprecision(0) << saved[i] / 1000 << "s ("
+                  << std::setprecision(2) << 100.0 * saved[i] / totalCost << "%)" << std::endl;
+    }
+}
+
+// 大量容量为 4 的小缓存（每连接缓存）：编译期容量的 FixedLruCache 与 LruBase 行为相同（都是 LRU），比较耗时
+template<typename CacheType>
+std::pair<int, double> runSmallCaches(std::vector<std::unique_ptr<CacheType>>& caches, int operations) {
+    std::mt19937 gen(31);
+    int hits = 0;
+    int value = 0;
+    Timer timer;
+    for (int op = 0; op < operations; ++op) {
+        auto& cache = *caches[gen() % caches.size()];
+        int key = std::min(gen() % 12, gen() % 12);
+        if (cache.get(key, value)) {
+            hits++;
+        } else {
+            cache.put(key, key);
+        }
+    }
+    return {hits, timer.elapsed()};
+}
+
+void testFixedCapacity() {
+    std::cout << "\n=== 测试场景17：编译期容量小缓存测试 ===" << std::endl;
+
+    const int CACHES = 4096;
+    const int OPERATIONS = 4000000;
+
+    std::vector<std::unique_ptr<MyCache::LruBase<int, int>>> lruCaches;
+    std::vector<std::unique_ptr<MyCache::FixedLruCache<int, int, 4>>> fixedCaches;
+    for (int i = 0; i < CACHES; ++i) {
+        lruCaches.emplace_back(new MyCache::LruBase<int, int>(4));
+        fixedCaches.emplace_back(new MyCache::FixedLruCache<int, int, 4>());
+    }
+
+    auto lru = runSmallCaches(lruCaches, OPERATIONS);
+    auto fixed = runSmallCaches(fixedCaches, OPERATIONS);
+    std::cout << "缓存个数: " << CACHES << " 每个容量: 4 操作次数: " << OPERATIONS << std::endl;
+    std::cout << "LruBase - 命中率: " << std::fixed << std::setprecision(2) << (100.0 * lru.first / OPERATIONS) << "%"
+              << " 耗时: " << std::setprecision(0) << lru.second << "ms"
+              << " 对象大小: " << sizeof(MyCache::LruBase<int, int>) << "B（另有哈希表与节点的堆内存）" << std::endl;
+    std::cout << "FixedLruCache - 命中率: " << std::setprecision(2) << (100.0 * fixed.first / OPERATIONS) << "%"
+              << " 耗时: " << std::setprecision(0) << fixed.second << "ms"
+              << " 对象大小: " << sizeof(MyCache::FixedLruCache<int, int, 4>) << "B（无堆分配）" << std::endl;
+}
+
+// 后端只有 30% 的 key 存在：比较仅缓存正结果与附加负缓存时的 loader 调用次数，并检查 put 使负条目失效、负条目按时过期
+void testNegativeCache() {
+    std::cout << "\n=== 测试场景18：负缓存测试 ===" << std::endl;
+
+    const int CAPACITY = 2000;
+    const int KEY_RANGE = 50000;
+    const int OPERATIONS = 400000;
+
+    auto exists = [](int key) { return key % 10 < 3; };
+    int plainLoads = 0;
+    int negativeLoads = 0;
+
+    MyCache::HashLruCaches<int, int> plain(CAPACITY, 4);
+    MyCache::HashNegativeCaches<int, int> negative(CAPACITY, 4, 40000, std::chrono::seconds(60));
+    auto loader = [&](int key) -> std::optional<int> {
+        negativeLoads++;
+        return exists(key) ? std::optional<int>(key) : std::nullopt;
+    };
+
+    std::mt19937 gen(37);
+    int value = 0;
+    for (int op = 0; op < OPERATIONS; ++op) {
+        int key = std::min(gen() % KEY_RANGE, gen() % KEY_RANGE);
+        if (!plain.get(key, value)) {
+            plainLoads++;
+            if (exists(key)) {
+                plain.put(key, key);
+            }
+        }
+        negative.getOrLoad(key, loader);
+    }
+
+    // 之前确认不存在的 key 被写入后应立即可见
+    int absentKey = 5;
+    negative.getOrLoad(absentKey, loader);
+    bool wasAbsent = negative.isKnownAbsent(absentKey);
+    negative.put(absentKey, 42);
+    auto afterPut = negative.getOrLoad(absentKey, loader);
+
+    MyCache::HashNegativeCaches<int, int> shortLived(CAPACITY, 4, 1000, std::chrono::milliseconds(20));
+    shortLived.markAbsent(7);
+    bool before = shortLived.isKnownAbsent(7);
+    std::this_thread::sleep_for(std::chrono::milliseconds(40));
+    bool after = shortLived.isKnownAbsent(7);
+
+    auto stats = negative.stats();
+    std::cout << "仅正缓存 - loader 调用: " << plainLoads << std::endl;
+    std::cout << "正缓存 + 负缓存 - loader 调用: " << negativeLoads
+              << " 负缓存命中: " << stats.negativeHits
+              << " 指纹表: " << negative.negativeBytes() / 1024 << "KB (每条 8B)" << std::endl;
+    std::cout << "put 后失效: " << (wasAbsent && afterPut && *afterPut == 42 ? "是" : "否")
+              << " 过期: " << (before && !after ? "是" : "否") << std::endl;
+}
+
+// 三个租户：A 工作集大、B 前半程活跃后半程空闲、C 热点很小。
+// 对比每个租户各自固定三分之一容量，与共享容量 + 最低保障的多租户缓存
+void testTenantQuotas() {
+    std::cout << "\n=== 测试场景19：多租户配额测试 ===" << std::endl;
+
+    const int CAPACITY = 3000;
+    const int OPERATIONS = 600000;
+    const int KEYS[3] = {4000, 1500, 300};
+
+    std::vector<std::unique_ptr<MyCache::HashLruCaches<int, int>>> fixed;
+    for (int t = 0; t < 3; ++t) {
+        fixed.emplace_back(new MyCache::HashLruCaches<int, int>(CAPACITY / 3, 4));
+    }
+    MyCache::HashTenantCaches<int, int> shared(CAPACITY, 4);
+    std::vector<MyCache::HashTenantCaches<int, int>::TenantId> ids = {
+        shared.addTenant(400), shared.addTenant(400), shared.addTenant(200, 600)};
+
+    std::vector<int> fixedHits(3, 0), sharedHits(3, 0), gets(3, 0);
+    std::mt19937 gen(41);
+    int value = 0;
+    for (int op = 0; op < OPERATIONS; ++op) {
+        int tenant = gen() % 3;
+        if (tenant == 1 && op > OPERATIONS / 2) {
+            tenant = 0;
+        }
+        int key = std::min(gen() % KEYS[tenant], gen() % KEYS[tenant]);
+        if (op > OPERATIONS / 2) {
+            gets[tenant]++;
+        }
+        if (fixed[tenant]->get(key, value)) {
+            fixedHits[tenant] += op > OPERATIONS / 2;
+        } else {
+            fixed[tenant]->put(key, key);
+        }
+        if (shared.get(ids[tenant], key, value)) {
+            sharedHits[tenant] += op > OPERATIONS / 2;
+        } else {
+            shared.put(ids[tenant], key, key);
+        }
+    }
+
+    std::cout << "后半程（租户 B 空闲）各租户命中率:" << std::endl;
+    const char* names[3] = {"A", "B", "C"};
+    for (int t = 0; t < 3; ++t) {
+        if (gets[t] == 0) {
+            continue;
+        }
+        auto stats = shared.stats(ids[t]);
+        std::cout << "  租户" << names[t] << " 固定分区: " << std::fixed << std::setprecision(2)
+                  << (100.0 * fixedHits[t] / gets[t]) << "% 共享配额: " << (100.0 * sharedHits[t] / gets[t]) << "%"
+                  << " 条目: " << stats.entries << " 被淘汰: " << stats.evictions << std::endl;
+    }
+    auto idle = shared.stats(ids[1]);
+    std::cout << "  租户B 空闲后保留条目: " << idle.entries << "（保障 400）" << std::endl;
+    int totalGets = gets[0] + gets[2];
+    std::cout << "  合计 固定分区: " << (100.0 * (fixedHits[0] + fixedHits[2]) / totalGets) << "% 共享配额: "
+              << (100.0 * (sharedHits[0] + sharedHits[2]) / totalGets) << "%" << std::endl;
+}
+
+// 批量预热：逐条 put 与 bulkLoad 的耗时对比，并检查容量不足时保留的是输入中较新的条目、重复 key 取较新的值
+void testBulkLoad() {
+    std::cout << "\n=== 测试场景20：批量装载测试 ===" << std::endl;
+
+    const int ENTRIES = 2000000;
+    const int CAPACITY = 1500000;
+    const int SLICES = 8;
+
+    std::vector<std::pair<int, int>> entries;
+    entries.reserve(ENTRIES + 1);
+    for (int i = 0; i < ENTRIES; ++i) {
+        entries.emplace_back(i, i * 2);
+    }
+    entries.emplace_back(ENTRIES - 1, -1);
+
+    auto check = [&](auto& cache) {
+        int value = 0;
+        bool newestKept = cache.get(ENTRIES - 2, value) && value == (ENTRIES - 2) * 2;
+        bool oldestDropped = !cache.get(0, value);
+        bool duplicateNewest = cache.get(ENTRIES - 1, value) && value == -1;
+        return newestKept && oldestDropped && duplicateNewest;
+    };
+
+    MyCache::HashLruCaches<int, int> lruPut(CAPACITY, SLICES);
+    Timer putTimer;
+    for (const auto& entry : entries) {
+        lruPut.put(entry.first, entry.second);
+    }
+    double putMs = putTimer.elapsed();
+
+    MyCache::HashLruCaches<int, int> lruBulk(CAPACITY, SLICES);
+    Timer bulkTimer;
+    lruBulk.bulkLoad(entries);
+    double bulkMs = bulkTimer.elapsed();
+
+    MyCache::HashLfu<int, int> lfuPut(CAPACITY, SLICES);
+    Timer lfuPutTimer;
+    for (const auto& entry : entries) {
+        lfuPut.put(entry.first, entry.second);
+    }
+    double lfuPutMs = lfuPutTimer.elapsed();
+
+    MyCache::HashLfu<int, int> lfuBulk(CAPACITY, SLICES);
+    Timer lfuBulkTimer;
+    lfuBulk.bulkLoad(entries);
+    double lfuBulkMs = lfuBulkTimer.elapsed();
+
+    std::cout << "条目数: " << entries.size() << " 容量: " << CAPACITY << std::endl;
+    std::cout << "HashLRU - 逐条 put: " << std::fixed << std::setprecision(0) << putMs << "ms"
+              << " bulkLoad: " << bulkMs << "ms 内容正确: " << (check(lruBulk) ? "是" : "否") << std::endl;
+    std::cout << "HashLFU - 逐条 put: " << lfuPutMs << "ms"
+              << " bulkLoad: " << lfuBulkMs << "ms 内容正确: " << (check(lfuBulk) ? "是" : "否") << std::endl;
+}
+
+void testMemoryUsage() {
+    std::cout << "\n=== 测试场景21：内存占用统计 ===" << std::endl;
+
+    const int CAPACITY = 100000;
+    const int SLICES = 4;
+    const std::string value(64, 'v');
+
+    MyCache::HashLruCaches<int, std::string> lru(CAPACITY, SLICES);
+    MyCache::HashLfu<int, std::string> lfu(CAPACITY, SLICES);
+    MyCache::HashCaches<int, std::string, MyCache::ArcCache<int, std::string>> arc(CAPACITY, SLICES);
+    // 写入两倍容量的 key 并读一遍，让 ARC 的两部分和幽灵表都装满
+    for (int key = 0; key < CAPACITY * 2; ++key) {
+        lru.put(key, value);
+        lfu.put(key, value);
+        arc.put(key, value);
+        arc.get(key);
+    }
+
+    auto report = [](const std::string& name, const MyCache::MemoryUsage& usage) {
+        double entries = std::max<size_t>(usage.entries, 1);
+        std::cout << name << " - 条目: " << usage.entries << std::fixed << std::setprecision(1)
+                  << " 每条目 索引: " << usage.indexBytes / entries << "B 元数据: " << usage.metadataBytes / entries
+                  << "B 数据: " << usage.payloadBytes / entries << "B 合计: " << usage.totalBytes() / entries << "B"
+                  << std::endl;
+    };
+    MyCache::MemoryUsage lruUsage = MyCache::totalOf(lru.memoryUsage());
+    report("LRU", lruUsage);
+    report("LFU", MyCache::totalOf(lfu.memoryUsage()));
+    report("ARC", MyCache::totalOf(arc.memoryUsage()));
+
+    // 删空后数据与索引节点都应归还，只剩桶数组与哨兵节点
+    for (int key = 0; key < CAPACITY * 2; ++key) {
+        lru.remove(key);
+    }
+    MyCache::MemoryUsage emptied = MyCache::totalOf(lru.memoryUsage());
+    std::cout << "LRU 删空后 - 条目: " << emptied.entries << " 数据: " << emptied.payloadBytes << "B"
+              << " 元数据: " << emptied.metadataBytes << "B 占用降为原来的 " << std::setprecision(1)
+              << 100.0 * emptied.totalBytes() / lruUsage.totalBytes() << "%" << std::endl;
+}
+
+void testSampledEviction() {
+    std::cout << "\n=== 测试场景22：采样淘汰测试 ===" << std::endl;
+
+    const int CAPACITY = 20000;
+    const int KEYS = 200000;
+    const int OPERATIONS = 2000000;
+
+    MyCache::LruBase<int, int> lru(CAPACITY);
+    MyCache::SampledCache<int, int> sampledLru(CAPACITY, MyCache::SampledPolicy::Lru);
+    MyCache::LfuBase<int, int> lfu(CAPACITY);
+    MyCache::SampledCache<int, int> sampledLfu(CAPACITY, MyCache::SampledPolicy::Lfu);
+
+    // 偏斜分布（u^3 映射到 key 空间），未命中时回填；每隔一段时间热点整体平移，考察老化
+    std::mt19937 gen(22);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    std::vector<int> trace(OPERATIONS);
+    for (int op = 0; op < OPERATIONS; ++op) {
+        double u = uniform(gen);
+        trace[op] = (static_cast<int>(u * u * u * KEYS) + op / (OPERATIONS / 4) * 5000) % KEYS;
+    }
+
+    auto run = [&](auto& cache) {
+        int hits = 0;
+        int value = 0;
+        Timer timer;
+        for (int key : trace) {
+            if (cache.get(key, value)) {
+                ++hits;
+            } else {
+                cache.put(key, key);
+            }
+        }
+        double ms = timer.elapsed();
+        MyCache::MemoryUsage usage = cache.memoryUsage();
+        std::cout << std::fixed << std::setprecision(2) << "命中率: " << 100.0 * hits / OPERATIONS << "%"
+                  << std::setprecision(0) << " 耗时: " << ms << "ms" << std::setprecision(1)
+                  << " 每条目字节: " << usage.totalBytes() / static_cast<double>(std::max<size_t>(usage.entries, 1))
+                  << "（索引 " << usage.indexBytes / static_cast<double>(std::max<size_t>(usage.entries, 1))
+                  << " 元数据 " << usage.metadataBytes / static_cast<double>(std::max<size_t>(usage.entries, 1))
+                  << "）" << std::endl;
+    };
+
+    std::cout << "缓存大小: " << CAPACITY << " key 空间: " << KEYS << " 操作次数: " << OPERATIONS << std::endl;
+    std::cout << "LRU       - ";
+    run(lru);
+    std::cout << "LRU(采样) - ";
+    run(sampledLru);
+    std::cout << "LFU       - ";
+    run(lfu);
+    std::cout << "LFU(采样) - ";
+    run(sampledLfu);
+}
+
+void testTagInvalidation() {
+    std::cout << "\n=== 测试场景23：按标签批量失效测试 ===" << std::endl;
+
+    const int USERS = 1000;
+    const int KEYS_PER_USER = 50;
+    const int CAPACITY = USERS * KEYS_PER_USER;
+    const int THREADS = 4;
+
+    // 每个 key 带两个标签：所属用户与所属地区（10 个地区）
+    MyCache::HashTaggedCaches<int, std::string> cache(CAPACITY, THREADS);
+    for (int user = 0; user < USERS; ++user) {
+        for (int i = 0; i < KEYS_PER_USER; ++i) {
+            int key = user * KEYS_PER_USER + i;
+            cache.put(key, "data" + std::to_string(key),
+                      {"user:" + std::to_string(user), "region:" + std::to_string(user % 10)});
+        }
+    }
+
+    auto countHits = [&](int firstUser, int lastUser) {
+        int hits = 0;
+        std::string value;
+        for (int key = firstUser * KEYS_PER_USER; key < lastUser * KEYS_PER_USER; ++key) {
+            hits += cache.get(key, value);
+        }
+        return hits;
+    };
+
+    // 失效一个用户（重复多次以便计时），同时其他线程持续读取无关的 key
+    std::atomic<bool> stop{false};
+    std::atomic<long long> background{0};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < THREADS; ++t) {
+        readers.emplace_back([&, t]() {
+            std::mt19937 gen(t);
+            std::string value;
+            while (!stop.load()) {
+                int key = (100 + gen() % (USERS - 100)) * KEYS_PER_USER + gen() % KEYS_PER_USER;
+                cache.get(key, value);
+                ++background;
+            }
+        });
+    }
+    const int INVALIDATIONS = 1000000;
+    Timer timer;
+    for (int i = 0; i < INVALIDATIONS; ++i) {
+        cache.invalidateTag("user:7");
+    }
+    double invalidateNs = timer.elapsed() * 1e6 / INVALIDATIONS;
+    stop = true;
+    for (auto& reader : readers) {
+        reader.join();
+    }
+
+    int userHits = countHits(7, 8);
+    int otherHits = countHits(0, 7) + countHits(8, 12);
+
+    // 失效一个地区，涉及 100 个用户的 5000 个 key
+    cache.invalidateTag("region:3");
+    int regionHits = 0;
+    for (int user = 3; user < USERS; user += 10) {
+        regionHits += countHits(user, user + 1);
+    }
+
+    // 加载期间发生的失效：加载结果不应留在缓存里
+    std::string loaded = cache.getOrLoad(7 * KEYS_PER_USER, {"user:7"}, [&](int key) {
+        cache.invalidateTag("user:7");
+        return "reloaded" + std::to_string(key);
+    });
+    std::string value;
+    bool racedLoadCached = cache.get(7 * KEYS_PER_USER, value);
+
+    MyCache::MemoryUsage usage = MyCache::totalOf(cache.memoryUsage());
+    std::cout << "条目: " << CAPACITY << " 每次失效耗时: " << std::fixed << std::setprecision(1) << invalidateNs
+              << "ns（期间后台读取 " << background.load() << " 次）" << std::endl;
+    std::cout << "user:7 剩余命中: " << userHits << "/" << KEYS_PER_USER << " 其他用户命中: " << otherHits << "/"
+              << 11 * KEYS_PER_USER << std::endl;
+    std::cout << "region:3 剩余命中: " << regionHits << "/" << USERS / 10 * KEYS_PER_USER
+              << " 加载期间失效的结果被缓存: " << (racedLoadCached ? "是" : "否") << std::endl;
+    std::cout << "惰性删除的过期条目: " << cache.stats().staleDrops << " 代数表: " << cache.tagTableBytes() / 1024
+              << "KB 每条目字节: " << std::setprecision(1) << usage.totalBytes() / static_cast<double>(usage.entries)
+              << std::endl;
+}
+
+// 回放访问轨迹：文件中每行一个整数 key，未命中时回填，统计各策略命中率与耗时
+void testTraceReplay(const std::string& path, int capacity) {
+    std::cout << "\n=== 轨迹回放测试: " << path << " ===" << std::endl;
+
+    std::vector<int> trace;
+    std::ifstream in(path);
+    for (long long key; in >> key; ) {
+        trace.push_back(static_cast<int>(key));
+    }
+    if (trace.empty()) {
+        std::cout << "轨迹为空或无法读取" << std::endl;
+        return;
+    }
+
+    MyCache::LruBase<int, std::string> lru(capacity);
+    MyCache::LfuBase<int, std::string> lfu(capacity);
+    MyCache::ArcCache<int, std::string> arc(capacity);
+    MyCache::LirsCache<int, std::string> lirs(capacity);
+    MyCache::S3FifoCache<int, std::string> s3fifo(capacity);
+    MyCache::AdaptiveArcCache<int, std::string> arcP(capacity);
+    MyCache::SampledCache<int, std::string> sampledLru(capacity, MyCache::SampledPolicy::Lru);
+    MyCache::SampledCache<int, std::string> sampledLfu(capacity, MyCache::SampledPolicy::Lfu);
+
+    std::vector<MyCache::CacheSer<int, std::string>*> caches = {&lru, &lfu, &arc, &lirs, &s3fifo, &arcP,
+                                                                &sampledLru, &sampledLfu};
+    std::vector<std::string> names = {"LRU", "LFU", "ARC", "LIRS", "S3-FIFO", "ARC(p)", "LRU(采样)", "LFU(采样)"};
+    std::vector<int> hits(caches.size(), 0);
+    std::vector<int> get_operations(caches.size(), 0);
+    std::vector<double> elapsed(caches.size(), 0);
+
+    for (size_t i = 0; i < caches.size(); ++i) {
+        Timer timer;
+        std::string result;
+        for (int key : trace) {
+            get_operations[i]++;
+            if (caches[i]->get(key, result)) {
+                hits[i]++;
+            } else {
+                caches[i]->put(key, "trace" + std::to_string(key));
+            }
+        }
+        elapsed[i] = timer.elapsed();
     }
 
-    printResults("工作负载剧烈变化测试", CAPACITY, get_operations, hits);
+    printResults("轨迹回放测试", capacity, names, get_operations, hits, elapsed);
 }
 
-int main() {
+int main(int argc, char* argv[]) {
+    if (argc > 1) {
+        testTraceReplay(argv[1], argc > 2 ? std::stoi(argv[2]) : 1000);
+        return 0;
+    }
+
     testHotDataAccess();
     testLoopPattern();
     testWorkloadShift();
+    testConcurrentRead();
+    testSlabChurn();
+    testCompression();
+    testFileTier();
+    testEvictionListener();
+    testWriteBack();
+    testAsyncLoad();
+    testHotKeys();
+    testScanResistance();
+    testAtomicUpdates();
+    testSharedMemory();
+    testAdaptivePolicy();
+    testCostAware();
+    testFixedCapacity();
+    testNegativeCache();
+    testTenantQuotas();
+    testBulkLoad();
+    testMemoryUsage();
+    testSampledEviction();
+    testTagInvalidation();
     return 0;
 }
\ No newline at end of file